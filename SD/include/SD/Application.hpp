@@ -10,6 +10,7 @@
 #include "SD/core/ApplicationRuntime.hpp"
 #include "SD/core/EngineServices.hpp"
 #include "SD/core/FrameTimer.hpp"
+#include "SD/core/JobSystem.hpp"
 #include "SD/core/LayerList.hpp"
 #include "SD/core/Scene.hpp"
 #include "SD/core/SceneManager.hpp"
@@ -141,7 +142,10 @@ struct SD_EXPORT Application {
     };
   }
 
-  [[nodiscard]] Arena* frame_arena() const { return m_frame_arena; }
+  // Lives until the GPU has finished this frame, then the arena is cleared for reuse
+  [[nodiscard]] Arena* frame_arena() const { return m_renderer->frame_arenas().current(); }
+
+  [[nodiscard]] JobSystem& jobs() const { return *m_job_system; }
 
   // Data members
   bool is_running;
@@ -162,7 +166,8 @@ struct SD_EXPORT Application {
   FrameTimer           timer;
 
   Arena* engine_arena;
-  Arena* m_frame_arena;
+
+  JobSystem* m_job_system;
 
   std::atomic<bool> m_restart_requested;
   std::atomic<bool> m_shader_reload_requested;
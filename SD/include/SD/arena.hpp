@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <type_traits>
 
 #include <sys/mman.h>
@@ -57,10 +58,27 @@ FORCE_INLINE T constexpr clamp(T a, T x, T b) {
 }
 
 
+// Blocks popped off a chained arena are kept on its free list and reused by later chain
+// extensions, instead of going back to the OS
+#ifndef ARENA_FREE_LIST
+#define ARENA_FREE_LIST 1
+#endif
+
+// Live arenas are linked into a global registry, see arena_registry_snapshot(). Their usage
+// counters are written with relaxed atomics so other threads can read them while the owner pushes.
+#ifndef ARENA_REGISTRY
+#define ARENA_REGISTRY 1
+#endif
+
 enum class ArenaFlags : U64 {
-  NONE        = 0,
-  NO_CHAIN    = (1 << 0),
-  LARGE_PAGES = (1 << 1),
+  NONE     = 0,
+  NO_CHAIN = (1 << 0),
+  // hugetlbfs pages, falls back to TRANSPARENT_HUGE_PAGES when none are reserved
+  LARGE_PAGES            = (1 << 1),
+  // Reservation aligned to the THP size and marked MADV_HUGEPAGE, commits grow in huge pages
+  TRANSPARENT_HUGE_PAGES = (1 << 2),
+  // Commits fault their pages in up front instead of on first touch
+  PREFAULT               = (1 << 3),
 };
 BITMASK_ENUM(ArenaFlags);
 
@@ -69,8 +87,10 @@ struct ArenaParams {
   U64                reserve_size            = mb(64uz);
   U64                commit_size             = kb(64uz);
   void*              optional_backing_buffer = nullptr;
-  sd::SourceLocation location                = sd::SourceLocation::current();
-  const char*        name                    = nullptr;
+  // Committed bytes of popped blocks kept for reuse, blocks past it are released
+  U64                free_list_cap = mb(64uz);
+  sd::SourceLocation location      = sd::SourceLocation::current();
+  const char*        name          = nullptr;
 };
 
 
@@ -94,12 +114,27 @@ struct SD_EXPORT Arena {
   U64                reserved;
   sd::SourceLocation location;
   const char*        name;
+  // Popped blocks linked through prev, only used on the first block
+  Arena* free_last;
+  U64    free_size;
+  U64    free_list_cap;
+  // Registry links and usage of the whole chain, free blocks included, only on the first block
+  Arena* registry_prev;
+  Arena* registry_next;
+  U64    stat_position;
+  U64    stat_high_water;
+  U64    stat_committed;
+  U64    stat_reserved;
+  U64    stat_blocks;
 
   void* push(this Arena& arena, U64 size, U64 align, bool zero);
   U64   pos(this Arena& arena);
   void  pop_to(this Arena& arena, U64 pos);
   void  clear(this Arena& arena);
   void  pop(this Arena& arena, U64 amount);
+  // Grows the allocation at `ptr` to `new_size` without moving it. Only possible when it is the
+  // last push of the current block and the block has room, returns false otherwise.
+  bool  try_extend(this Arena& arena, void* ptr, U64 old_size, U64 new_size, bool zero);
 
   [[nodiscard]] Temp temp_begin(this Arena& arena);
 
@@ -133,3 +168,36 @@ T* arena_push_no_zero(Arena* arena) {
 
 SD_EXPORT Arena* arena_alloc(ArenaParams params = {});
 SD_EXPORT void   arena_release(Arena* arena);
+
+//~ registry
+struct ArenaInfo {
+  const char*        name;
+  sd::SourceLocation location;
+  U64                position;
+  U64                high_water;
+  U64                committed;
+  U64                reserved;
+  U64                blocks;
+};
+
+// Copies the usage of every live arena into `arena`
+SD_EXPORT std::span<ArenaInfo> arena_registry_snapshot(Arena* arena);
+
+//~ scratch
+// Each thread owns SCRATCH_ARENA_COUNT scratch arenas, allocated on first use. Pass the arenas the
+// caller is already pushing into, the returned one is none of them, so a temp popped by a callee
+// never takes the caller's allocations with it.
+#ifndef SCRATCH_ARENA_COUNT
+#define SCRATCH_ARENA_COUNT 2
+#endif
+
+SD_EXPORT Arena* get_scratch(Arena* const* conflicts, U64 count);
+
+template<typename... Arenas>
+[[nodiscard]] Temp scratch_begin(Arenas*... conflicts) {
+  Arena* const list[] = {conflicts..., nullptr};
+  return get_scratch(list, sizeof...(conflicts))->temp_begin();
+}
+FORCE_INLINE void scratch_end(Temp temp) {
+  temp.end();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+#include "SD/arena.hpp"
+#include "SD/core/types.hpp"
+#include "SD/export.hpp"
+
+namespace sd {
+
+struct CommandQueue;
+template<typename... Ts>
+struct ComponentGroup;
+template<typename ExtraComponents>
+struct EntityManager;
+
+using JobFn = void (*)(void* ctx, USize begin, USize end);
+
+struct Job {
+  JobFn             fn      = nullptr;
+  void*             ctx     = nullptr;
+  USize             begin   = 0;
+  USize             end     = 0;
+  std::atomic<U32>* pending = nullptr;
+};
+
+/**
+ * Fixed size Chase-Lev deque. The owning worker pushes and pops at the bottom, other workers
+ * steal from the top.
+ */
+struct WorkStealingDeque {
+  static constexpr USize CAPACITY = 4096;
+  static constexpr USize MASK     = CAPACITY - 1;
+
+  alignas(64) std::atomic<I64> top{0};
+  alignas(64) std::atomic<I64> bottom{0};
+  std::atomic<Job*> buffer[CAPACITY];
+
+  // Owner only. Returns false when full, the caller runs the job inline instead
+  bool push(Job* job);
+  // Owner only
+  Job* pop();
+  // Any thread
+  Job* steal();
+};
+
+/**
+ * Fixed pool of worker threads with per-worker deques and stealing. The thread that constructs
+ * the system is worker 0 and helps execute jobs while it waits on them.
+ *
+ * Every worker owns a scratch arena and a CommandQueue. Jobs must not change ECS structure
+ * directly, they record into local_commands() and the owner merges them with flush_commands()
+ * once the parallel section is done.
+ *
+ * parallel_for() called from a thread that is not a worker of this system runs all chunks inline
+ * on that thread. local_scratch(), local_commands() and worker_index() are for workers only.
+ */
+struct SD_EXPORT JobSystem {
+  // worker_count == 0 picks hardware_concurrency() - 1 background workers
+  explicit JobSystem(Arena* arena, U32 worker_count = 0);
+  ~JobSystem();
+
+  JobSystem(const JobSystem&)            = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // Splits [0, count) into chunks of `grain` and calls fn(begin, end) for each, blocking until
+  // all chunks are done. Runs inline when the caller is not a worker
+  template<typename Fn>
+  void parallel_for(USize count, USize grain, Fn&& fn) {
+    using Callable = std::remove_reference_t<Fn>;
+    run_chunks(
+        count,
+        grain,
+        [](void* ctx, USize begin, USize end) { (*static_cast<Callable*>(ctx))(begin, end); },
+        &fn);
+  }
+
+  void run_chunks(USize count, USize grain, JobFn fn, void* ctx);
+
+  // Thread local views, valid from any worker including worker 0
+  [[nodiscard]] Arena*        local_scratch() const;
+  [[nodiscard]] CommandQueue& local_commands() const;
+  [[nodiscard]] U32           worker_index() const;
+  [[nodiscard]] U32           thread_count() const { return m_thread_count; }
+  // True on worker 0, the constructing thread, and on the background workers
+  [[nodiscard]] bool on_worker() const;
+
+  // Applies every worker's queue in worker order, then clears them. Commands must have been
+  // recorded for EntityManager<ExtraComponents>, see CommandQueue::add. Defined in CommandQueue.hpp
+  template<typename ExtraComponents>
+  void flush_commands(EntityManager<ExtraComponents>& em);
+  // Resets all scratch arenas, call once no job is running
+  void reset_scratch();
+
+  struct Worker {
+    WorkStealingDeque deque;
+    std::thread       thread;
+    Arena*            scratch  = nullptr;
+    CommandQueue*     commands = nullptr;
+  };
+
+  void worker_loop(U32 index);
+  bool try_run_one(U32 index);
+  void execute(Job* job);
+
+  Worker*           m_workers      = nullptr;
+  U32               m_thread_count = 0;
+  std::atomic<bool> m_running{true};
+  // Jobs pushed but not yet taken, idle workers sleep on it
+  std::atomic<U32> m_queued{0};
+};
+
+} // namespace sd
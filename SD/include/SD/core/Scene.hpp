@@ -1,15 +1,37 @@
 #pragma once
 
 #include "SD/arena.hpp"
+#include "ecs/ArchetypeEntityManager.hpp"
 #include "ecs/CommandQueue.hpp"
 #include "ecs/EntityManager.hpp"
+#include "ecs/RenderSnapshot.hpp"
+#include "ecs/TransformHierarchy.hpp"
 
 namespace sd {
 
+// Entity storage backend of a scene, fixed at construction
+enum class SceneStorage : U8 {
+  SparseSet,
+  Archetype,
+};
+
 struct Scene {
-  explicit Scene(std::string name = "Untitled Scene", Arena* pool_arena = nullptr) :
-    m_name(std::move(name)) {
-    em.m_pool_arena = pool_arena;
+  explicit Scene(std::string  name       = "Untitled Scene",
+                 Arena*       pool_arena = nullptr,
+                 SceneStorage storage    = SceneStorage::SparseSet) :
+    m_name(std::move(name)), m_storage(storage) {
+    em.m_pool_arena           = pool_arena;
+    archetype_em.m_pool_arena = pool_arena;
+  }
+
+  ~Scene() {
+    // Unregisters its observers from em, so it goes first
+    if (m_transform_hierarchy) {
+      m_transform_hierarchy->~TransformHierarchy();
+      arena_release(m_hierarchy_arena);
+    }
+    if (m_owned_pool_arena)
+      arena_release(m_owned_pool_arena);
   }
 
   Scene(const Scene&)            = delete;
@@ -17,7 +39,28 @@ struct Scene {
 
   void on_start() { m_is_active = true; }
   void on_stop() { m_is_active = false; }
-  void on_update(float dt) { (void)dt; }
+  // Called by Application once a frame after the layers ran, before render snapshots are taken
+  void on_update(float dt) {
+    (void)dt;
+    if (m_transform_hierarchy)
+      m_transform_hierarchy->propagate(m_hierarchy_jobs);
+  }
+
+  // Keeps Transform in sync with LocalTransform through Parent/Children links. on_update()
+  // propagates it, split across `jobs` when given
+  void enable_transform_hierarchy(JobSystem* jobs = nullptr) {
+    ASSERT(m_storage == SceneStorage::SparseSet && "Transform hierarchy needs sparse set storage");
+    m_hierarchy_jobs = jobs;
+    if (m_transform_hierarchy)
+      return;
+    m_hierarchy_arena     = arena_alloc(ArenaParams{.name = "SceneHierarchyArena"});
+    m_transform_hierarchy = arena_push<TransformHierarchy<ComponentGroup<>>>(m_hierarchy_arena);
+    new (m_transform_hierarchy) TransformHierarchy<ComponentGroup<>>(em, m_hierarchy_arena);
+  }
+  // Null until enable_transform_hierarchy()
+  [[nodiscard]] TransformHierarchy<ComponentGroup<>>* transform_hierarchy() {
+    return m_transform_hierarchy;
+  }
 
   [[nodiscard]] bool               is_active() const { return m_is_active; }
   [[nodiscard]] const std::string& get_name() const { return m_name; }
@@ -27,18 +70,69 @@ struct Scene {
     m_commands.add<T>(std::forward<Args>(args)...);
   }
 
+  // Calls fn with whichever manager backs this scene, both expose the same entity API
+  template<typename Fn>
+  decltype(auto) with_storage(Fn&& fn) {
+    if (m_storage == SceneStorage::Archetype)
+      return fn(archetype_em);
+    return fn(em);
+  }
+
+  [[nodiscard]] SceneStorage get_storage() const { return m_storage; }
+
   void apply_commands() {
+    // Commands target the sparse set manager only
+    ASSERT(m_storage == SceneStorage::SparseSet && "Scene commands need sparse set storage");
     m_commands.apply(em);
     m_commands.clear();
   }
 
   [[nodiscard]] USize command_count() const;
 
-  EntityManager<ComponentGroup<>> em;
+  // Moves the sparse set manager into an arena of its own at exact size. The arena given at
+  // construction is shared with archetype_em and whoever passed it, so only arenas created here
+  // are released
+  void compact() {
+    ASSERT(m_storage == SceneStorage::SparseSet && "Only sparse set storage can be compacted");
+    Arena* fresh = arena_alloc(ArenaParams{.name = "ScenePoolArena"});
+    Arena* old   = em.compact(fresh);
+    if (m_transform_hierarchy)
+      m_transform_hierarchy->mark_dirty();
+    if (old == m_owned_pool_arena && old)
+      arena_release(old);
+    m_owned_pool_arena = fresh;
+  }
+
+  // Opts the scene into per frame render snapshots, taken by Application after simulation
+  void enable_render_snapshots() { m_render_snapshots = true; }
+  [[nodiscard]] bool wants_render_snapshot() const {
+    return m_render_snapshots && m_storage == SceneStorage::SparseSet;
+  }
+  void take_render_snapshot(Arena* frame_arena) {
+    m_render_snapshot = extract_render_snapshot(em, frame_arena);
+  }
+  // Forgets the pointer only, the data is released with its frame arena slot
+  void drop_render_snapshot() { m_render_snapshot = nullptr; }
+  // Null when no snapshot was taken this frame
+  [[nodiscard]] const RenderSnapshot* render_snapshot() const { return m_render_snapshot; }
+
+  EntityManager<ComponentGroup<>>          em;
+  ArchetypeEntityManager<ComponentGroup<>> archetype_em;
 
   CommandQueue m_commands;
   std::string  m_name;
+  SceneStorage m_storage   = SceneStorage::SparseSet;
   bool         m_is_active = false;
+
+  const RenderSnapshot* m_render_snapshot  = nullptr;
+  bool                  m_render_snapshots = false;
+
+  // Set once compact() moved em into an arena of its own
+  Arena* m_owned_pool_arena = nullptr;
+
+  TransformHierarchy<ComponentGroup<>>* m_transform_hierarchy = nullptr;
+  Arena*                                m_hierarchy_arena     = nullptr;
+  JobSystem*                            m_hierarchy_jobs      = nullptr;
 };
 
 inline USize Scene::command_count() const {
@@ -10,9 +10,11 @@
 namespace sd {
 
 struct Scene;
+enum class SceneStorage : U8;
 
 struct SD_EXPORT SceneManager {
   Scene* create(Arena* arena, const std::string& name);
+  Scene* create(Arena* arena, const std::string& name, SceneStorage storage);
   Scene* get(const std::string& name) const;
 
   template<typename F>
@@ -31,7 +33,22 @@ struct SD_EXPORT SceneManager {
 
   void clear();
 
+  // Compacts sparse set scenes whose pool arena is mostly waste. Runs between frames, component
+  // pointers held across the call are invalidated
+  void compact_wasteful(float waste_threshold);
+  // Called by Application once a frame. Clears every scene's change lists and checks for waste
+  // every COMPACT_CHECK_INTERVAL frames
+  void end_frame();
+
+  static constexpr U32 COMPACT_CHECK_INTERVAL = 256;
+  // Below this many wasted bytes compaction is not worth the copy
+  static constexpr U64 MIN_COMPACT_WASTE = mb(1);
+
+  // Waste ratio above which end_frame() compacts a scene, 0 disables it
+  float auto_compact_waste = 0.0f;
+
   std::vector<Scene*> m_scenes;
+  U32                 m_frames_since_check = 0;
 };
 
 } // namespace sd
@@ -7,16 +7,27 @@ struct ArenaVec {
   T*  data  = nullptr;
   U64 count = 0;
   U64 cap   = 0;
+  // Bytes left behind in the arena by reserves that had to move the array
+  U64 abandoned = 0;
 
   void push(Arena* arena, const T& item) {
-    if (count >= cap) {
-      cap         = cap ? cap * 2 : 16;
-      T* new_data = arena->push_array<T>(cap);
+    if (count >= cap)
+      reserve(arena, cap ? cap * 2 : 16);
+    data[count++] = item;
+  }
+
+  void reserve(Arena* arena, U64 new_cap) {
+    if (new_cap <= cap)
+      return;
+    // Still the arena's last allocation, grow in place instead of leaking the old array
+    if (!data || !arena->try_extend(data, cap * sizeof(T), new_cap * sizeof(T), true)) {
+      T* new_data = arena->push_array<T>(new_cap);
       for (U64 i = 0; i < count; ++i)
         new_data[i] = data[i];
+      abandoned += cap * sizeof(T);
       data = new_data;
     }
-    data[count++] = item;
+    cap = new_cap;
   }
 
   void clear() {
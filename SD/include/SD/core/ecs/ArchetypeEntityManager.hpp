@@ -0,0 +1,240 @@
+#pragma once
+#include <array>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+
+#include "ComponentFactory.hpp"
+#include "ComponentMask.hpp"
+#include "Entity.hpp"
+#include "SD/arena.hpp"
+#include "SD/core/arena_vec.hpp"
+#include "SD/core/logging.hpp"
+#include "component_registration.hpp"
+#include "components.hpp"
+
+namespace sd {
+
+template<typename ExtraComponents>
+struct ArchetypeEntityManager;
+
+/**
+ * Type erased per component operations used by archetype chunks. Rows are moved between chunks
+ * with relocate_fn, which is a plain memcpy for trivially copyable components.
+ */
+struct ArchetypeComponentLayout {
+  U32 size  = 0;
+  U32 align = 0;
+
+  void (*construct_fn)(void* dst)           = nullptr;
+  void (*relocate_fn)(void* dst, void* src) = nullptr;
+  void (*destroy_fn)(void* ptr)             = nullptr;
+
+  template<typename T>
+  static constexpr ArchetypeComponentLayout of() {
+    ArchetypeComponentLayout layout;
+    layout.size         = sizeof(T);
+    layout.align        = alignof(T);
+    layout.construct_fn = [](void* dst) { new (dst) T{}; };
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      layout.relocate_fn = [](void* dst, void* src) { std::memcpy(dst, src, sizeof(T)); };
+      layout.destroy_fn  = [](void*) {};
+    } else {
+      layout.relocate_fn = [](void* dst, void* src) {
+        new (dst) T(std::move(*static_cast<T*>(src)));
+        static_cast<T*>(src)->~T();
+      };
+      layout.destroy_fn = [](void* ptr) { static_cast<T*>(ptr)->~T(); };
+    }
+    return layout;
+  }
+};
+
+template<typename Group>
+inline constexpr auto k_archetype_layouts = 0;
+
+template<typename... Ts>
+inline constexpr std::array<ArchetypeComponentLayout, sizeof...(Ts)>
+    k_archetype_layouts<ComponentGroup<Ts...>> = {ArchetypeComponentLayout::of<Ts>()...};
+
+/**
+ * Entities sharing one ComponentMask, stored in fixed size chunks. Each chunk holds `capacity`
+ * rows as one Entity column followed by one column per component. Every chunk but the last is
+ * full, removal swaps the very last row into the hole.
+ */
+template<USize ComponentCount, typename Mask>
+struct Archetype {
+  static constexpr U32 NO_COLUMN = g_type_max<U32>;
+
+  Mask mask;
+  U32  capacity = 0;
+
+  // Byte offset of each component's column inside a chunk, NO_COLUMN when absent
+  U32 column_offset[ComponentCount];
+
+  ArenaVec<U8*> chunks;
+  U64           entity_count = 0;
+
+  // Cached transitions when adding or removing one component
+  Archetype* add_edge[ComponentCount];
+  Archetype* remove_edge[ComponentCount];
+};
+
+template<typename ExtraComponents, typename... Components>
+struct ArchetypeView {
+  using manager_type   = ArchetypeEntityManager<ExtraComponents>;
+  using archetype_type = typename manager_type::archetype_type;
+
+  manager_type& m_manager;
+
+  explicit ArchetypeView(manager_type& manager) : m_manager(manager) {}
+
+  struct Iterator {
+    const ArchetypeView* view;
+    USize                archetype;
+    USize                chunk;
+    U32                  row;
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::tuple<Entity, Components&...>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = value_type;
+
+    Iterator& operator++();
+
+    bool operator==(const Iterator& other) const {
+      return archetype == other.archetype && chunk == other.chunk && row == other.row;
+    }
+
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    std::tuple<Entity, Components&...> operator*() const;
+
+    // Moves forward to the first row of the next matching, non-empty archetype
+    void settle();
+  };
+
+  Iterator begin() const;
+  Iterator end() const;
+
+  // Calls fn(Entity, Components&...) with column pointers hoisted per chunk
+  template<typename Fn>
+  void each(Fn&& fn) const;
+
+  [[nodiscard]] bool matches(const archetype_type& archetype) const;
+};
+
+/**
+ * Archetype backed alternative to EntityManager with the same entity API. Entities with identical
+ * component masks share 16 KiB chunks from the pool arena, so iteration is a linear walk over
+ * contiguous columns. Adding or removing a component relocates the entity's row into the target
+ * archetype, one memcpy per column for trivially copyable components.
+ *
+ * The serialize() wire format matches EntityManager, so either backend can load the other's data.
+ */
+template<typename ExtraComponents>
+struct ArchetypeEntityManager {
+  using all_components = ConcatComponentGroups_t<components::EngineComponents, ExtraComponents>;
+
+  template<typename T>
+  using component_info = ComponentTraits<T, all_components>;
+
+  static_assert(IsUniqueComponentGroup<all_components>::value,
+                "Duplicate component type in ECS schema");
+
+  static constexpr USize COMPONENT_COUNT   = ComponentGroupSize<all_components>::value;
+  static constexpr USize CHUNK_SIZE        = kb(16);
+  static constexpr USize CHUNK_HEADER_SIZE = 64;
+
+  static_assert(COMPONENT_COUNT <= 256, "At most 256 component types are supported");
+
+  using ComponentMask  = ComponentMaskFor<COMPONENT_COUNT>;
+  using archetype_type = Archetype<COMPONENT_COUNT, ComponentMask>;
+
+  struct ChunkHeader {
+    U32 count;
+  };
+
+  struct EntityLocation {
+    archetype_type* archetype = nullptr;
+    U32             chunk     = 0;
+    U32             row       = 0;
+  };
+
+  Entity create();
+  void   destroy(Entity e);
+
+  template<typename T, typename... Args>
+  T* add_component(Entity e, Args&&... args);
+
+  template<typename T>
+  bool try_remove_component(Entity e);
+
+  template<typename T>
+  T* try_get_component(Entity e);
+
+  template<typename T>
+  T& get_component(Entity e);
+
+  template<typename T>
+  const T& get_component(Entity e) const;
+
+  template<typename T>
+  [[nodiscard]] bool has_component(Entity e) const;
+
+  template<typename... Components>
+  ArchetypeView<ExtraComponents, Components...> view() {
+    return ArchetypeView<ExtraComponents, Components...>(*this);
+  }
+
+  void serialize(Serializer& s) const;
+  void deserialize(Serializer& s);
+
+  void clear();
+
+  [[nodiscard]] bool is_alive(Entity e) const;
+
+  // Slots ever handed out, index 0 is the reserved null entity
+  [[nodiscard]] int get_entity_count() const {
+    return m_generations.count ? static_cast<int>(m_generations.count) - 1 : 0;
+  }
+  [[nodiscard]] int get_alive_entity_count() const;
+
+  //~ chunk and archetype internals
+  static constexpr const auto& s_layouts = k_archetype_layouts<all_components>;
+
+  // Calls fn.template operator()<T>() for the component whose id is `id`
+  template<typename Fn>
+  static void dispatch_component(USize id, Fn&& fn);
+
+  static ChunkHeader* chunk_header(U8* chunk) { return reinterpret_cast<ChunkHeader*>(chunk); }
+  static Entity*      chunk_entities(U8* chunk) {
+    return reinterpret_cast<Entity*>(chunk + CHUNK_HEADER_SIZE);
+  }
+  static void* column_ptr(const archetype_type& archetype, U8* chunk, USize id, U32 row) {
+    return chunk + archetype.column_offset[id] + static_cast<USize>(row) * s_layouts[id].size;
+  }
+
+  archetype_type* find_or_create_archetype(const ComponentMask& mask);
+  EntityLocation  allocate_row(archetype_type* archetype, Entity e);
+  // Swap-removes a row. Components still in the row are destroyed only if `destroy_components`
+  void remove_row(const EntityLocation& location, bool destroy_components);
+  // Relocates the entity's shared components into `target`, destroying ones `target` lacks
+  void move_entity(Entity e, archetype_type* target);
+  U32  pop_free_list();
+
+  Arena* m_pool_arena = nullptr;
+
+  ArenaVec<U32>            m_generations;
+  ArenaVec<U32>            m_free_list;
+  ArenaVec<EntityLocation> m_locations;
+
+  ArenaVec<archetype_type*> m_archetypes;
+  ArenaVec<U8*>             m_free_chunks;
+  archetype_type*           m_empty_archetype = nullptr;
+};
+
+#include "impl/ArchetypeEntityManager.inl"
+} // namespace sd
@@ -25,8 +25,10 @@ struct EntityHandle {
 struct CommandNode {
   U64   type_id;
   void* data;
+  // EntityManager type execute_fn casts `em` to
+  U64 manager_type_id;
 
-  void (*execute_fn)(void* data, EntityManager<ComponentGroup<>>& em, CommandQueue& queue);
+  void (*execute_fn)(void* data, void* em, CommandQueue& queue);
   void (*serialize_fn)(void* data, Serializer& s);
   void (*deserialize_fn)(void* data, Serializer& s);
 };
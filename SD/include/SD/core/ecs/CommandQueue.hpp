@@ -5,13 +5,15 @@
 
 #include "Command.hpp"
 #include "Entity.hpp"
+#include "SD/core/JobSystem.hpp"
 #include "SD/core/arena_vec.hpp"
 
 namespace sd {
 
+// Deserialized commands target EntityManager<ComponentGroup<>>, execute_fn casts `em` to it
 struct TypeErasedCommandEntry {
   void* (*alloc_fn)(Arena* arena);
-  void (*execute_fn)(void* data, EntityManager<ComponentGroup<>>& em, CommandQueue& queue);
+  void (*execute_fn)(void* data, void* em, CommandQueue& queue);
   void (*serialize_fn)(void* data, Serializer& s);
   void (*deserialize_fn)(void* data, Serializer& s);
 };
@@ -28,24 +30,36 @@ struct CommandQueue {
   CommandQueue(CommandQueue&&)                 = delete;
   CommandQueue& operator=(CommandQueue&&)      = delete;
 
-  template<typename T, typename... Args>
+  // Records T for a manager of type Manager, apply() must be given one of that type
+  template<typename T, typename Manager = EntityManager<ComponentGroup<>>, typename... Args>
   void add(Args&&... args) {
     T* data = m_arena->push_array<T>(1);
     *data   = T(std::forward<Args>(args)...);
     m_commands.push(
         m_arena,
         CommandNode{
-            .type_id        = type_id_of<T>(),
-            .data           = data,
-            .execute_fn     = [](void*                            d,
-                                 EntityManager<ComponentGroup<>>& em,
-                                 CommandQueue& queue) { static_cast<T*>(d)->execute(em, queue); },
+            .type_id         = type_id_of<T>(),
+            .data            = data,
+            .manager_type_id = type_id_of<Manager>(),
+            .execute_fn =
+                [](void* d, void* em, CommandQueue& queue) {
+                  static_cast<T*>(d)->execute(*static_cast<Manager*>(em), queue);
+                },
             .serialize_fn   = [](void* d, Serializer& s) { static_cast<T*>(d)->serialize(s); },
             .deserialize_fn = [](void* d, Serializer& s) { static_cast<T*>(d)->deserialize(s); },
         });
   }
 
-  void apply(EntityManager<ComponentGroup<>>& em);
+  template<typename ExtraComponents>
+  void apply(EntityManager<ExtraComponents>& em) {
+    for (U64 i = 0; i < m_commands.count; ++i) {
+      auto& cmd = m_commands.data[i];
+      ASSERT(cmd.manager_type_id == type_id_of<EntityManager<ExtraComponents>>() &&
+             "Command was recorded for another manager type");
+      cmd.execute_fn(cmd.data, &em, *this);
+    }
+    clear();
+  }
 
   [[nodiscard]] Entity get_entity(EntityHandle handle) const;
   void                 set_entity_for_handle(EntityHandle entity_handle, Entity entity);
@@ -72,4 +86,11 @@ struct CommandQueue {
   static inline std::unordered_map<U64, TypeErasedCommandEntry> s_type_entries;
 };
 
+// JobSystem.hpp only forward declares CommandQueue, so the templated flush is defined here
+template<typename ExtraComponents>
+void JobSystem::flush_commands(EntityManager<ExtraComponents>& em) {
+  for (U32 i = 0; i < m_thread_count; ++i)
+    m_workers[i].commands->apply(em);
+}
+
 } // namespace sd
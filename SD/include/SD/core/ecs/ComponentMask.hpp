@@ -0,0 +1,76 @@
+#pragma once
+
+#include <initializer_list>
+
+#include "SD/core/types.hpp"
+
+namespace sd {
+
+/**
+ * Fixed width component bitmask stored as raw 64 bit words.
+ * Views precompute the mask of the components they require and test an entity with a single
+ * AND/compare per word instead of one bit lookup per component.
+ */
+template<USize Bits>
+struct BasicComponentMask {
+  static_assert(Bits > 0 && Bits % 64 == 0, "Component mask width must be a multiple of 64");
+  static constexpr USize BIT_COUNT  = Bits;
+  static constexpr USize WORD_COUNT = Bits / 64;
+
+  U64 words[WORD_COUNT] = {};
+
+  static constexpr BasicComponentMask from_ids(std::initializer_list<USize> ids) {
+    BasicComponentMask mask;
+    for (USize id : ids)
+      mask.set(id);
+    return mask;
+  }
+
+  [[nodiscard]] constexpr bool test(USize bit) const {
+    return (words[bit >> 6] >> (bit & 63)) & 1;
+  }
+  constexpr void set(USize bit) { words[bit >> 6] |= U64(1) << (bit & 63); }
+  constexpr void reset(USize bit) { words[bit >> 6] &= ~(U64(1) << (bit & 63)); }
+  constexpr void reset() {
+    for (U64& word : words)
+      word = 0;
+  }
+
+  // True when every bit of `required` is also set here. Accumulates instead of early-outs so the
+  // loop unrolls into straight line code.
+  [[nodiscard]] constexpr bool contains(const BasicComponentMask& required) const {
+    U64 missing = 0;
+    for (USize i = 0; i < WORD_COUNT; ++i)
+      missing |= required.words[i] & ~words[i];
+    return missing == 0;
+  }
+
+  // contains(include) with no bit of `exclude` set, both folded into the same pass over the words
+  [[nodiscard]] constexpr bool matches(const BasicComponentMask& include,
+                                       const BasicComponentMask& exclude) const {
+    U64 mismatch = 0;
+    for (USize i = 0; i < WORD_COUNT; ++i)
+      mismatch |= (include.words[i] & ~words[i]) | (exclude.words[i] & words[i]);
+    return mismatch == 0;
+  }
+
+  [[nodiscard]] constexpr bool none() const {
+    U64 any = 0;
+    for (U64 word : words)
+      any |= word;
+    return any == 0;
+  }
+
+  constexpr bool operator==(const BasicComponentMask&) const = default;
+};
+
+// Narrowest mask holding `ComponentCount` component ids: 64, 128 or 256 bits
+template<USize ComponentCount>
+using ComponentMaskFor = BasicComponentMask<(ComponentCount <= 64    ? 64
+                                             : ComponentCount <= 128 ? 128
+                                                                     : 256)>;
+
+// Masks are always written as 256 bits so saved scenes don't depend on the component count
+inline constexpr USize SERIALIZED_MASK_WORDS = 4;
+
+} // namespace sd
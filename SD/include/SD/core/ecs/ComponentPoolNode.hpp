@@ -1,10 +1,24 @@
 #pragma once
 
 #include "Entity.hpp"
+#include "SD/core/arena_vec.hpp"
 
 namespace sd {
 
 struct Serializer;
+struct PoolStats;
+
+enum class ComponentEvent : U8 {
+  Construct, // after add_component
+  Update,    // after patch
+  Destroy,   // before the component is removed, also when its entity is destroyed
+};
+
+// Observers must not add or remove components of the type they observe
+struct ComponentObserver {
+  void (*fn)(void* user, Entity e) = nullptr;
+  void* user                        = nullptr;
+};
 
 struct ComponentPoolNode {
   void* pool = nullptr;
@@ -12,6 +26,39 @@ struct ComponentPoolNode {
   bool (*remove_fn)(void* pool, Entity e)           = nullptr;
   void (*serialize_fn)(void* pool, Serializer& s)   = nullptr;
   void (*deserialize_fn)(void* pool, Serializer& s) = nullptr;
+  void (*clear_changed_fn)(void* pool)              = nullptr;
+  PoolStats (*stats_fn)(const void* pool)           = nullptr;
+  // Moves the pool into `arena` at exact size and returns the new pool
+  void* (*compact_fn)(void* pool, Arena* arena) = nullptr;
+
+  ArenaVec<ComponentObserver> on_construct;
+  ArenaVec<ComponentObserver> on_update;
+  ArenaVec<ComponentObserver> on_destroy;
+
+  // Owning group this pool is packed for, if any. A pool can be owned by at most one group
+  void* group                                                      = nullptr;
+  void (*group_on_add_fn)(void* group, const void* mask, Entity e) = nullptr;
+  void (*group_on_remove_fn)(void* group, Entity e)                = nullptr;
+  // Copies the group into `arena` over the pools of `nodes`, indexed by component id
+  void* (*group_relocate_fn)(const void* group, Arena* arena, const ComponentPoolNode* nodes) =
+      nullptr;
+
+  ArenaVec<ComponentObserver>& observers(ComponentEvent event) {
+    switch (event) {
+      case ComponentEvent::Construct:
+        return on_construct;
+      case ComponentEvent::Update:
+        return on_update;
+      case ComponentEvent::Destroy:
+        break;
+    }
+    return on_destroy;
+  }
+
+  static void notify(const ArenaVec<ComponentObserver>& observers, Entity e) {
+    for (const ComponentObserver& observer : observers)
+      observer.fn(observer.user, e);
+  }
 };
 
 } // namespace sd
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <meta>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SD/core/type_id.hpp"
+#include "SD/core/types.hpp"
+#include "SD/export.hpp"
+
+namespace sd {
+
+// Layout and lifetime of a component type known only at runtime. Null move_fn and destroy_fn mean
+// the type is copied with memcpy and needs no destructor
+struct ComponentTypeInfo {
+  U64              stable_id = 0;
+  std::string_view name;
+  U32              size  = 0;
+  U32              align = 0;
+  // Move constructs into uninitialized `dst`, `src` is destroyed separately
+  void (*move_fn)(void* dst, void* src) = nullptr;
+  void (*destroy_fn)(void* p)           = nullptr;
+
+  [[nodiscard]] bool same_layout(const ComponentTypeInfo& other) const {
+    return size == other.size && align == other.align;
+  }
+
+  template<typename T>
+  static constexpr ComponentTypeInfo of(std::string_view name) {
+    ComponentTypeInfo info{.stable_id = type_id_of<T>(),
+                           .name      = name,
+                           .size      = static_cast<U32>(sizeof(T)),
+                           .align     = static_cast<U32>(alignof(T))};
+    if constexpr (!std::is_trivially_copyable_v<T>)
+      info.move_fn = [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); };
+    if constexpr (!std::is_trivially_destructible_v<T>)
+      info.destroy_fn = [](void* p) { static_cast<T*>(p)->~T(); };
+    return info;
+  }
+};
+
+/**
+ * Component types registered at runtime, e.g. by a game module, without being part of the
+ * compile-time ComponentGroup an EntityManager is built with.
+ *
+ * Types are keyed by a stable 64-bit id and handed a dense slot on first registration. Slots are
+ * never reused or cleared, registering the same id again only rebinds its info, which is how a
+ * reloaded module takes over the pools its previous build created. The name must outlive the
+ * registration, the hot reloader keeps old modules mapped until exit.
+ */
+struct SD_EXPORT ComponentRegistry {
+  static constexpr U32 INVALID_SLOT = g_type_max<U32>;
+
+  // Returns the slot of info.stable_id, adding it when new
+  static U32                      register_type(const ComponentTypeInfo& info);
+  static U32                      slot_of(U64 stable_id);
+  static const ComponentTypeInfo& info(U32 slot);
+  static U32                      count();
+
+  template<typename T>
+  static U32 register_type(std::string_view name) {
+    return register_type(ComponentTypeInfo::of<T>(name));
+  }
+
+  static inline std::vector<ComponentTypeInfo> m_types;
+  static inline std::unordered_map<U64, U32>   m_slots;
+  // Bumped whenever an existing slot is rebound, pools holding an older info compare against it
+  static inline U64 m_revision = 0;
+};
+
+// Slot of T, registered by the first call from each module
+template<typename T>
+U32 runtime_component_slot() {
+  static const U32 slot = ComponentRegistry::register_type<T>(std::meta::identifier_of(^^T));
+  return slot;
+}
+
+} // namespace sd
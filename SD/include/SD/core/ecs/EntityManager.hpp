@@ -1,11 +1,23 @@
 #pragma once
-#include <bitset>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <iterator>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 #include "ComponentFactory.hpp"
+#include "ComponentMask.hpp"
 #include "ComponentPoolNode.hpp"
 #include "Entity.hpp"
+#include "Prefab.hpp"
+#include "RuntimeComponentPool.hpp"
 #include "SD/arena.hpp"
+#include "SD/core/JobSystem.hpp"
 #include "SD/core/logging.hpp"
 #include "SparseEntitySet.hpp"
 #include "component_registration.hpp"
@@ -16,28 +28,93 @@ namespace sd {
 template<typename ExtraComponents>
 struct EntityManager;
 
+/**
+ * View filter. view<Changed<Transform>, Renderable>() visits only entities whose Transform was
+ * added or written through patch() or get_mut() since the last clear_changes(), driven by the
+ * pool's changed list so the cost follows the change rate. Needs track_changes<Transform>().
+ * With several Changed terms the shortest list drives and the entity must be in every list
+ */
+template<typename T>
+struct Changed {};
+
+// View term yielding component_ptr_t<T>, null when the entity lacks T. Never filters entities
+template<typename T>
+struct Optional {};
+
+// view<Renderable, Transform>(exclude<Hidden>) skips entities having any of Ts
+template<typename... Ts>
+struct Exclude {};
+
+template<typename... Ts>
+inline constexpr Exclude<Ts...> exclude{};
+
+template<typename T>
+struct ViewTerm {
+  using type                     = T;
+  using result                   = component_ref_t<T>;
+  static constexpr bool changed  = false;
+  static constexpr bool optional = false;
+  static constexpr bool tag      = TagComponent<T>;
+};
+
+template<typename T>
+struct ViewTerm<Changed<T>> : ViewTerm<T> {
+  static_assert(!TagComponent<T>, "Tags have no data to change");
+  static constexpr bool changed = true;
+};
+
+template<typename T>
+struct ViewTerm<Optional<T>> : ViewTerm<T> {
+  using result                   = component_ptr_t<T>;
+  static constexpr bool optional = true;
+};
+
+template<typename T>
+using view_component_t = typename ViewTerm<T>::type;
+template<typename T>
+using view_result_t = typename ViewTerm<T>::result;
+
 template<typename ExtraComponents = ComponentGroup<>, typename... Components>
 struct ViewImpl {
   using manager_type   = EntityManager<ExtraComponents>;
   using all_components = ConcatComponentGroups_t<components::EngineComponents, ExtraComponents>;
 
-  manager_type&           m_manager;
-  const ArenaVec<Entity>* m_smallest_pool = nullptr;
+  template<typename T>
+  using component_info = ComponentTraits<T, all_components>;
+
+  static constexpr bool  has_changed_filter = (ViewTerm<Components>::changed || ...);
+  static constexpr USize changed_count      = (ViewTerm<Components>::changed + ...);
+  static constexpr USize required_count     = (!ViewTerm<Components>::optional + ...);
+  // Required terms with a pool, only these can drive iteration
+  static constexpr USize driver_count =
+      ((!ViewTerm<Components>::optional && !ViewTerm<Components>::tag) + ...);
+
+  static_assert(driver_count > 0, "A view needs at least one non-optional, non-tag component");
 
-  explicit ViewImpl(manager_type& manager);
+  using Mask = typename manager_type::ComponentMask;
+
+  manager_type&                                                 m_manager;
+  std::tuple<SparseEntitySet<view_component_t<Components>>*...> m_pools{};
+  const PagedVec<Entity>*                                       m_smallest_pool = nullptr;
+  // Components an entity must not have, set by view(exclude<...>)
+  Mask m_exclude{};
+  // False when the driving pool alone decides membership, no mask load needed
+  bool m_test_mask = true;
+
+  explicit ViewImpl(manager_type& manager, const Mask& exclude = {});
 
   struct Iterator {
-    manager_type&           manager;
-    const ArenaVec<Entity>* entities;
+    const ViewImpl*         view;
+    const PagedVec<Entity>* entities;
     USize                   index;
 
     using iterator_category = std::forward_iterator_tag;
-    using value_type        = std::tuple<Entity, Components&...>;
+    using value_type        = std::tuple<Entity, view_result_t<Components>...>;
     using difference_type   = std::ptrdiff_t;
     using pointer           = void;
     using reference         = value_type;
 
-    Iterator(manager_type& em, const ArenaVec<Entity>* dense_entities, USize idx);
+    Iterator(const ViewImpl* v, const PagedVec<Entity>* dense_entities, USize idx);
     Iterator& operator++();
 
     bool operator==(const Iterator& other) const {
@@ -46,7 +123,7 @@ struct ViewImpl {
 
     bool operator!=(const Iterator& other) const { return !(*this == other); }
 
-    std::tuple<Entity, Components&...> operator*() const;
+    value_type operator*() const;
 
     void next();
 
@@ -56,8 +133,96 @@ struct ViewImpl {
   Iterator begin();
   Iterator end();
 
+  // Splits the driving pool into chunks of `grain` and calls fn(Entity, components...) on the job
+  // system. Each dense slot belongs to one chunk, so writing the view's components is safe.
+  // Structural changes go through jobs.local_commands() and are applied by flush_commands()
+  template<typename Fn>
+  void par_each(JobSystem& jobs, Fn&& fn, USize grain = 256);
+
+  [[nodiscard]] bool matches(Entity e) const;
+
   template<typename Component>
   void check_size(USize& minSize);
+
+  template<typename Component>
+  view_result_t<Component> fetch(Entity e, USize dense_idx) const;
+};
+
+/**
+ * Owning group: keeps the dense arrays of every owned pool ordered so that entities having all of
+ * `Owned` occupy the same prefix [0, size). Iterating the group walks that prefix in every pool in
+ * lockstep, with no sparse lookups. Created through EntityManager::group() and kept up to date by
+ * the group hooks in ComponentPoolNode.
+ */
+template<typename ExtraComponents, typename... Owned>
+struct GroupImpl {
+  static_assert(sizeof...(Owned) >= 2, "An owning group needs at least two components");
+
+  using manager_type   = EntityManager<ExtraComponents>;
+  using all_components = ConcatComponentGroups_t<components::EngineComponents, ExtraComponents>;
+
+  template<typename T>
+  using component_info = ComponentTraits<T, all_components>;
+
+  std::tuple<SparseEntitySet<Owned>*...> m_pools{};
+  USize                                  m_size = 0;
+
+  explicit GroupImpl(SparseEntitySet<Owned>*... pools) : m_pools(pools...) {}
+
+  struct Iterator {
+    const GroupImpl* group;
+    USize            index;
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::tuple<Entity, component_ref_t<Owned>...>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = value_type;
+
+    Iterator& operator++() {
+      ++index;
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return index == other.index && group == other.group;
+    }
+
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    std::tuple<Entity, component_ref_t<Owned>...> operator*() const;
+  };
+
+  Iterator begin() const { return Iterator{this, 0}; }
+  Iterator end() const { return Iterator{this, m_size}; }
+
+  [[nodiscard]] USize size() const { return m_size; }
+  [[nodiscard]] bool  contains(Entity e) const;
+
+  // Calls fn(Entity, components...) indexing every owned dense array directly, the tightest loop
+  // a group allows
+  template<typename Fn>
+  void each(Fn&& fn);
+
+  // Orders the group by less(a, b) over one owned component, the other owned pools follow so the
+  // prefix stays in lockstep
+  template<typename Component, typename Compare>
+  void sort(Compare&& less);
+
+  // Column of an SoA owned component limited to the group, e.g.
+  // column<Renderable, ^^Renderable::view_mask>()
+  template<typename Component, std::meta::info Member>
+  auto column() const;
+
+  static constexpr auto required_mask();
+
+  // ComponentPoolNode hooks. `mask` is the entity's manager ComponentMask after the add
+  static void on_add(void* group, const void* mask, Entity e);
+  static void on_remove(void* group, Entity e);
+  static void* relocate(const void* group, Arena* arena, const ComponentPoolNode* nodes);
+
+  void pack(Entity e);
+  void unpack(Entity e);
 };
 
 template<typename ExtraComponents>
@@ -70,18 +235,60 @@ struct EntityManager {
   static_assert(IsUniqueComponentGroup<all_components>::value,
                 "Duplicate component type in ECS schema");
   Entity create();
+  // Fills `out` with new entities, recycled indices first
+  void create_many(std::span<Entity> out);
 
   template<typename T, typename... Args>
-  T* add_component(Entity e, Args&&... args);
+  component_ptr_t<T> add_component(Entity e, Args&&... args);
+
+  // Bulk add_component, values[i] goes to entities[i]. Existing components are overwritten
+  template<typename T>
+  void add_components(std::span<const Entity> entities, std::span<const T> values);
+
+  // Generator form, make(i) builds the component for entities[i]
+  template<typename T, typename Fn>
+    requires std::invocable<Fn&, USize>
+  void add_components(std::span<const Entity> entities, Fn&& make);
 
   template<typename T>
-  T* try_get_component(Entity e);
+  component_ptr_t<T> try_get_component(Entity e);
 
   template<typename T>
-  T& get_component(Entity e);
+  component_ref_t<T> get_component(Entity e);
+
+  // Writes through fn(component), marks the component changed and notifies Update observers
+  template<typename T, typename Fn>
+  void patch(Entity e, Fn&& fn);
+
+  // Marks the component changed before handing it out. Update observers are not notified
+  template<typename T>
+  component_ref_t<T> get_mut(Entity e);
+
+  // Reorders T's pool by less(a, b) so views driven by it visit entities in that order. Pools
+  // owned by a group are sorted through GroupImpl::sort instead
+  template<typename T, typename Compare>
+  void sort(Compare&& less);
+
+  // Reorders T's pool to follow Other's dense order, shared entities first
+  template<typename T, typename Other>
+  void sort_as();
+
+  // Enables change tracking on T's pool, required by views with a Changed<T> filter
+  template<typename T>
+  void track_changes();
+
+  // Empties every changed list. SceneManager::end_frame() calls it once a frame for every scene
+  void clear_changes();
+
+  template<typename T>
+  void observe(ComponentEvent event, ComponentObserver observer);
+  // Removes every registration of observer for event. Observers hold raw pointers, so whatever
+  // `user` points at unregisters before it dies. Not callable from inside an observer
+  template<typename T>
+  void unobserve(ComponentEvent event, ComponentObserver observer);
 
   template<typename T>
-  const T& get_component(Entity e) const;
+  component_cref_t<T> get_component(Entity e) const;
 
   void serialize(Serializer& s) const;
   void deserialize(Serializer& s);
@@ -90,27 +297,72 @@ struct EntityManager {
   bool try_remove_component(Entity e);
 
   void destroy(Entity e);
+  void destroy_many(std::span<const Entity> entities);
+
+  // Copies the entity's trivially copyable components into a prefab whose blob lives in `arena`.
+  // Other components are left out with a warning, k_prefab_component opt-outs like the hierarchy
+  // links are left out silently
+  Prefab capture_prefab(Entity e, Arena* arena) const;
+  // Creates out.size() entities holding the prefab's components, each component is added to its
+  // pool in one bulk copy
+  void instantiate(const Prefab& prefab, std::span<Entity> out);
+
+  // Components outside the compiled ComponentGroup, keyed by ComponentRegistry slot. They have no
+  // mask bit, so views, groups and observers do not see them. add moves from `value`
+  void* add_runtime_component(Entity e, U32 slot, void* value);
+  void* try_get_runtime_component(Entity e, U32 slot);
+  bool  remove_runtime_component(Entity e, U32 slot);
+
+  template<typename T>
+  T* add_runtime_component(Entity e, T value);
+  template<typename T>
+  T* try_get_runtime_component(Entity e);
+  template<typename T>
+  bool remove_runtime_component(Entity e);
+
+  // Moves runtime pools onto the registry's current infos and drops those whose layout changed.
+  // Runs on the next runtime component access after a registration was rebound
+  void rebind_runtime_components();
 
   void clear() {
+    for (RuntimeComponentPool* pool : m_runtime_pools) {
+      if (pool)
+        pool->clear();
+    }
+    m_runtime_pools.clear();
     m_component_pools.clear();
-    m_entity_masks.clear();
-    m_generations.clear();
+    m_records.clear();
     m_free_list.clear();
+    m_alive_count = 0;
     if (m_pool_arena)
       m_pool_arena->clear();
   }
 
   [[nodiscard]] bool is_alive(Entity e) const;
-  [[nodiscard]] int  get_entity_count() const { return m_entity_masks.size(); }
-  [[nodiscard]] int  get_alive_entity_count() const {
-    int alive = 0;
-    for (U64 i = 0; i < m_entity_masks.get_dense_entities().count; ++i) {
-      Entity e = m_entity_masks.get_dense_entities()[i];
-      if (e.index < m_generations.count && is_alive(e))
-        ++alive;
-    }
-    return alive;
+  // Slots ever handed out, index 0 is the reserved null entity
+  [[nodiscard]] int get_entity_count() const {
+    return m_records.count ? static_cast<int>(m_records.count) - 1 : 0;
   }
+  [[nodiscard]] int get_alive_entity_count() const { return static_cast<int>(m_alive_count); }
+
+  // Calls fn(type_id, name, const PoolStats&) for every allocated pool. Tags have no pool
+  template<typename Fn>
+  void for_each_pool_stats(Fn&& fn) const;
+  // Everything pushed to the pool arena, entity records and group state included
+  [[nodiscard]] U64 arena_position() const { return m_pool_arena ? m_pool_arena->pos() : 0; }
+  // Pool stats and arena position as one JSON object, for tooling sizing ArenaParams
+  [[nodiscard]] std::string pool_stats_json() const;
+  // Bytes compact() would keep
+  [[nodiscard]] U64 live_bytes() const;
+  // Bytes this manager's records and pools hold, growth leftovers included. Unlike
+  // arena_position() it stays per manager when several share one arena
+  [[nodiscard]] U64 footprint_bytes() const;
+
+  // Moves pools, groups and entity records into `fresh` at exact size and switches to it. Dead
+  // entity slots after the last live one are dropped, live entities keep their handles. Returns
+  // the previous arena, the caller releases it if nothing else lives there. Invalidates component
+  // pointers, views and group references, so run it between frames
+  Arena* compact(Arena* fresh);
 
   template<typename T>
   struct UnpackGroup {
@@ -132,14 +384,22 @@ struct EntityManager {
   template<typename... Args>
   auto view();
 
+  template<typename... Args, typename... Excluded>
+  auto view(Exclude<Excluded...>);
+
+  // Owning group over Owned. Created on first call, later calls return the same group. A
+  // component can be owned by at most one group
+  template<typename... Owned>
+  GroupImpl<ExtraComponents, Owned...>& group();
+
   template<typename T>
   [[nodiscard]] bool has_component(Entity e) const;
 
   template<typename... Components>
-  std::tuple<Components&...> get_component_group(Entity e);
+  std::tuple<component_ref_t<Components>...> get_component_group(Entity e);
 
   template<typename... Components>
-  std::tuple<const Components&...> get_component_group(Entity e) const;
+  std::tuple<component_cref_t<Components>...> get_component_group(Entity e) const;
 
   template<typename T>
   SparseEntitySet<T>* get_component_pool();
@@ -147,16 +407,55 @@ struct EntityManager {
   template<typename T>
   bool has_component_pool();
 
+  template<typename T>
+  SparseEntitySet<T>* ensure_pool();
+  // Grows the node table without creating a pool, tags only ever have the node
+  ComponentPoolNode& ensure_node(USize type_id);
+
+  template<TagComponent T>
+  void add_tags(std::span<const Entity> entities);
+
+  // Per component halves of capture_prefab and instantiate, looked up by component id
+  template<typename T>
+  void capture_component(Entity e, void* dst) const;
+  template<typename T>
+  void instantiate_component(std::span<const Entity> entities, const PrefabComponent& component,
+                             const U8* data);
+
+  static constexpr USize COMPONENT_COUNT = ComponentGroupSize<all_components>::value;
+  static_assert(COMPONENT_COUNT <= 256, "At most 256 component types are supported");
+
+  using ComponentMask = ComponentMaskFor<COMPONENT_COUNT>;
+
+  static constexpr auto COMPONENT_NAMES = []<typename... Ts>(ComponentGroup<Ts...>) {
+    return std::array<std::string_view, sizeof...(Ts)>{component_info<Ts>::name...};
+  }(all_components{});
+
+  // Per entity index state, sized so a record never straddles a cache line
+  struct alignas(std::bit_ceil(sizeof(U64) + sizeof(ComponentMask))) EntityRecord {
+    U32           generation = 0;
+    U32           alive      = 0;
+    ComponentMask mask;
+  };
+
   Arena* m_pool_arena = nullptr;
   U32    pop_free_list();
 
-  ArenaVec<U32> m_generations;
-  ArenaVec<U32> m_free_list;
+  ArenaVec<EntityRecord> m_records;
+  ArenaVec<U32>          m_free_list;
+  U64                    m_alive_count = 0;
+  // Generation new entity slots start at, above every slot compact() dropped
+  U32 m_generation_floor = 0;
 
   ArenaVec<ComponentPoolNode> m_component_pools;
 
-  using ComponentMask = std::bitset<256>;
-  SparseEntitySet<ComponentMask> m_entity_masks;
+  RuntimeComponentPool* runtime_pool(U32 slot);
+  RuntimeComponentPool* ensure_runtime_pool(U32 slot);
+
+  // Indexed by registry slot, null until the slot is first used here
+  ArenaVec<RuntimeComponentPool*> m_runtime_pools;
+  // ComponentRegistry::m_revision the pools were last rebound at
+  U64 m_runtime_revision = 0;
 
   friend class RuntimeStateManager;
 };
@@ -0,0 +1,77 @@
+#pragma once
+#include "SD/arena.hpp"
+#include "SD/core/arena_vec.hpp"
+#include "SD/core/types.hpp"
+#include "SD/utils/serialization.hpp"
+
+namespace sd {
+
+// Specialize to false for components whose values only make sense on the captured entity, like
+// links to other entities. capture_prefab leaves them out
+template<typename T>
+inline constexpr bool k_prefab_component = true;
+
+// One component of a Prefab, `size` bytes at `offset` in Prefab::data. Tags have size 0
+struct PrefabComponent {
+  U32 type_id = 0;
+  U32 size    = 0;
+  U32 offset  = 0;
+};
+
+/**
+ * Component values captured from an entity by EntityManager::capture_prefab, spawned again in bulk
+ * by EntityManager::instantiate.
+ *
+ * The values are packed into one blob in component id order and copied into the pools with
+ * memcpy, so only trivially copyable components take part. Component ids are those of the manager
+ * the prefab was captured from. The blob lives in `arena`, a prefab holds no other memory.
+ */
+struct Prefab {
+  static constexpr U64 DATA_ALIGN = 64;
+
+  Arena*                    arena = nullptr;
+  ArenaVec<PrefabComponent> components;
+  U8*                       data      = nullptr;
+  U32                       data_size = 0;
+
+  [[nodiscard]] bool empty() const { return components.count == 0; }
+
+  [[nodiscard]] const PrefabComponent* find(U32 type_id) const {
+    for (const PrefabComponent& component : components) {
+      if (component.type_id == type_id)
+        return &component;
+    }
+    return nullptr;
+  }
+
+  void serialize(Serializer& s) const {
+    s.write(static_cast<U32>(components.count));
+    for (const PrefabComponent& component : components) {
+      s.write(component.type_id);
+      s.write(component.size);
+      s.write(component.offset);
+    }
+    s.write(data_size);
+    s.write(data, data_size);
+  }
+
+  // Reads into `arena`, which must be set
+  void deserialize(Serializer& s) {
+    assert(arena && "Prefab needs an arena to deserialize into");
+    components.clear();
+    U32 count = s.read<U32>();
+    components.reserve(arena, count);
+    for (U32 i = 0; i < count; ++i) {
+      PrefabComponent component;
+      component.type_id = s.read<U32>();
+      component.size    = s.read<U32>();
+      component.offset  = s.read<U32>();
+      components.push(arena, component);
+    }
+    data_size = s.read<U32>();
+    data      = static_cast<U8*>(arena->push(data_size, DATA_ALIGN, false));
+    s.read(data, data_size);
+  }
+};
+
+} // namespace sd
@@ -0,0 +1,38 @@
+#pragma once
+#include <new>
+
+#include "EntityManager.hpp"
+#include "SD/arena.hpp"
+#include "SD/core/arena_vec.hpp"
+#include "components.hpp"
+
+namespace sd {
+
+/**
+ * Immutable copy of the render relevant pools, taken once simulation of a frame is done and
+ * stored in the frame arena slot of that frame. Rendering reads only the snapshot, so it never
+ * races the next simulation step, and the arrays stay valid until the GPU finished the frame.
+ * Command buffers are still recorded on the main thread, right after extraction.
+ *
+ * Drawables are the entities having both Transform and Renderable, their arrays share one index.
+ * When a Transform/Renderable owning group packs them, extraction is a block copy of the dense
+ * arrays, otherwise it gathers them through a view.
+ */
+struct RenderSnapshot {
+  ArenaVec<Entity>                entities;
+  ArenaVec<components::Transform> transforms;
+  // Same SoA layout as the Renderable pool, so columns copy with one memcpy each
+  SoAVec<components::Renderable> renderables;
+
+  ArenaVec<Entity>             camera_entities;
+  ArenaVec<components::Camera> cameras;
+
+  [[nodiscard]] USize drawable_count() const { return entities.count; }
+};
+
+// Allocates the snapshot and every array it holds in `arena`, it lives until the arena is cleared
+template<typename ExtraComponents>
+const RenderSnapshot* extract_render_snapshot(EntityManager<ExtraComponents>& em, Arena* arena);
+
+#include "impl/RenderSnapshot.inl"
+} // namespace sd
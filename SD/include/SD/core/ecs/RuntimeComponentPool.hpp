@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "ComponentRegistry.hpp"
+#include "Entity.hpp"
+#include "SD/arena.hpp"
+#include "SD/core/arena_vec.hpp"
+#include "SparseEntitySet.hpp"
+
+namespace sd {
+
+/**
+ * Pool of one ComponentRegistry slot, for components an EntityManager was not compiled with.
+ *
+ * Same sparse to dense layout as SparseEntitySet, with rows of info.size bytes handled through
+ * the info's function pointers. The pool keeps the info it was built with, so a module reload
+ * re-registering the slot takes effect through rebind().
+ */
+struct RuntimeComponentPool {
+  static constexpr USize SHIFT = math::log2_int(SPARSE_PAGE_SIZE);
+  static constexpr USize MASK  = SPARSE_PAGE_SIZE - 1;
+
+  ComponentTypeInfo info;
+  Arena*            arena = nullptr;
+
+  // Pages never written point at k_sparse_empty_page
+  ArenaVec<U32*>   sparse_pages;
+  ArenaVec<Entity> dense_entities;
+  U8*              dense_data = nullptr;
+  U64              data_cap   = 0;
+  // Row blocks left in the arena by growth
+  U64 abandoned_bytes = 0;
+
+  static U32* empty_page() { return const_cast<U32*>(k_sparse_empty_page.data()); }
+
+  [[nodiscard]] USize size() const { return dense_entities.count; }
+
+  U8* row(USize dense_idx) { return dense_data + dense_idx * info.size; }
+
+  USize dense_index(Entity entity) const {
+    USize page = entity.index >> SHIFT;
+    if (page >= sparse_pages.count)
+      return std::numeric_limits<USize>::max();
+    U32 dense_idx = sparse_pages[page][entity.index & MASK];
+    if (dense_idx == SPARSE_NONE || dense_entities[dense_idx] != entity)
+      return std::numeric_limits<USize>::max();
+    return dense_idx;
+  }
+
+  void* get(Entity entity) {
+    USize dense_idx = dense_index(entity);
+    return dense_idx == std::numeric_limits<USize>::max() ? nullptr : row(dense_idx);
+  }
+
+  // Move constructs the entity's component from `value`, replacing the current one. The caller
+  // still destroys `value`
+  void* add(Entity entity, void* value) {
+    USize dense_idx = dense_index(entity);
+    if (dense_idx != std::numeric_limits<USize>::max()) {
+      destroy(row(dense_idx));
+      move_construct(row(dense_idx), value);
+      return row(dense_idx);
+    }
+
+    ensure_page(entity.index >> SHIFT);
+    reserve(size() + 1);
+    dense_idx = size();
+    move_construct(row(dense_idx), value);
+    sparse_pages[entity.index >> SHIFT][entity.index & MASK] = static_cast<U32>(dense_idx);
+    dense_entities.push(arena, entity);
+    return row(dense_idx);
+  }
+
+  bool remove(Entity entity) {
+    USize dense_idx = dense_index(entity);
+    if (dense_idx == std::numeric_limits<USize>::max())
+      return false;
+
+    USize  last_idx    = size() - 1;
+    Entity last_entity = dense_entities[last_idx];
+    destroy(row(dense_idx));
+    if (dense_idx != last_idx) {
+      relocate(row(dense_idx), row(last_idx));
+      dense_entities[dense_idx] = last_entity;
+      sparse_pages[last_entity.index >> SHIFT][last_entity.index & MASK] =
+          static_cast<U32>(dense_idx);
+    }
+    sparse_pages[entity.index >> SHIFT][entity.index & MASK] = SPARSE_NONE;
+    dense_entities.count--;
+    return true;
+  }
+
+  // Destroys every row, keeping pages and capacity
+  void clear() {
+    for (USize i = 0; i < size(); ++i) {
+      Entity entity = dense_entities[i];
+      destroy(row(i));
+      sparse_pages[entity.index >> SHIFT][entity.index & MASK] = SPARSE_NONE;
+    }
+    dense_entities.count = 0;
+  }
+
+  // Adopts the slot's current registration. A changed layout cannot be carried over, the rows are
+  // destroyed with the old info and false is returned
+  bool rebind(const ComponentTypeInfo& current) {
+    if (!info.same_layout(current)) {
+      clear();
+      return false;
+    }
+    info = current;
+    return true;
+  }
+
+  // Moves `other` into this pool's arena at exact size, only pages holding entries are kept
+  void compact_from(RuntimeComponentPool& other) {
+    info = other.info;
+    dense_entities.reserve(arena, other.size());
+    dense_data = static_cast<U8*>(arena->push(other.size() * info.size, info.align, false));
+    data_cap   = other.size();
+    for (USize i = 0; i < other.size(); ++i) {
+      Entity entity = other.dense_entities[i];
+      relocate(row(i), other.row(i));
+      ensure_page(entity.index >> SHIFT);
+      sparse_pages[entity.index >> SHIFT][entity.index & MASK] = static_cast<U32>(i);
+      dense_entities.push(arena, entity);
+    }
+    other.dense_entities.count = 0;
+  }
+
+  [[nodiscard]] U64 live_bytes() const {
+    U64 occupied = 0;
+    for (U32* page : sparse_pages)
+      occupied += page != empty_page();
+    return size() * (info.size + sizeof(Entity)) + occupied * SPARSE_PAGE_SIZE * sizeof(U32) +
+           sparse_pages.count * sizeof(U32*);
+  }
+
+  // Everything pushed to the arena so far, abandoned rows included
+  [[nodiscard]] U64 footprint_bytes() const {
+    U64 occupied = 0;
+    for (U32* page : sparse_pages)
+      occupied += page != empty_page();
+    return data_cap * info.size + abandoned_bytes + dense_entities.cap * sizeof(Entity) +
+           dense_entities.abandoned + occupied * SPARSE_PAGE_SIZE * sizeof(U32) +
+           sparse_pages.cap * sizeof(U32*) + sparse_pages.abandoned;
+  }
+
+  void ensure_page(USize page) {
+    while (sparse_pages.count <= page)
+      sparse_pages.push(arena, empty_page());
+    if (sparse_pages[page] == empty_page()) {
+      sparse_pages[page] = arena->push_array_no_zero<U32>(SPARSE_PAGE_SIZE);
+      std::memset(sparse_pages[page], 0xFF, SPARSE_PAGE_SIZE * sizeof(U32));
+    }
+  }
+
+  void reserve(USize n) {
+    if (n <= data_cap)
+      return;
+    U64 new_cap  = std::max<U64>({n, data_cap * 2, 16});
+    U8* new_data = static_cast<U8*>(arena->push(new_cap * info.size, info.align, false));
+    for (USize i = 0; i < size(); ++i)
+      relocate(new_data + i * info.size, row(i));
+    abandoned_bytes += data_cap * info.size;
+    dense_data = new_data;
+    data_cap   = new_cap;
+  }
+
+  void move_construct(void* dst, void* src) const {
+    if (info.move_fn)
+      info.move_fn(dst, src);
+    else
+      std::memcpy(dst, src, info.size);
+  }
+
+  // Moves the component at `src` into uninitialized `dst` and ends the lifetime of `src`
+  void relocate(void* dst, void* src) const {
+    move_construct(dst, src);
+    destroy(src);
+  }
+
+  void destroy(void* p) const {
+    if (info.destroy_fn)
+      info.destroy_fn(p);
+  }
+};
+
+} // namespace sd
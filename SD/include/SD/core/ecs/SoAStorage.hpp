@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstring>
+#include <meta>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SD/arena.hpp"
+#include "SD/core/arena_vec.hpp"
+#include "SD/core/paged_vec.hpp"
+#include "SD/core/types.hpp"
+
+namespace sd {
+
+/**
+ * Opt-in structure-of-arrays storage. Specialize to true for a component whose systems usually
+ * touch a few members, each non-static data member then lives in its own dense column.
+ *   template<> inline constexpr bool k_soa_component<Renderable> = true;
+ */
+template<typename T>
+inline constexpr bool k_soa_component = false;
+
+// Columns are moved with memcpy, so SoA components must be trivially copyable
+template<typename T>
+concept SoAComponent = k_soa_component<T> && std::is_trivially_copyable_v<T> &&
+                       std::is_default_constructible_v<T>;
+
+/**
+ * Reflected member layout of T. Ref and ConstRef are generated aggregates with one reference
+ * member per data member of T, under the same name, so `ref.view_mask` reads like the struct.
+ */
+template<typename T>
+struct SoALayout {
+  static constexpr auto members = std::define_static_array(
+      std::meta::nonstatic_data_members_of(^^T, std::meta::access_context::unchecked()));
+  static constexpr USize count = members.size();
+
+  template<USize I>
+  using member_t = typename[:std::meta::type_of(members[I]):];
+
+  template<USize I>
+  static member_t<I>& get(T& item) {
+    return item.[:members[I]:];
+  }
+  template<USize I>
+  static const member_t<I>& get(const T& item) {
+    return item.[:members[I]:];
+  }
+
+  template<std::meta::info Member>
+  static consteval USize index_of() {
+    for (USize i = 0; i < count; ++i) {
+      if (members[i] == Member)
+        return i;
+    }
+    return static_cast<USize>(-1);
+  }
+
+  struct Ref;
+  struct ConstRef;
+  consteval {
+    std::vector<std::meta::info> ref_members;
+    std::vector<std::meta::info> const_ref_members;
+    for (std::meta::info member : members) {
+      std::meta::info type = std::meta::type_of(member);
+      std::meta::data_member_options options{.name = std::meta::identifier_of(member)};
+      ref_members.push_back(
+          std::meta::data_member_spec(std::meta::add_lvalue_reference(type), options));
+      const_ref_members.push_back(std::meta::data_member_spec(
+          std::meta::add_lvalue_reference(std::meta::add_const(type)), options));
+    }
+    std::meta::define_aggregate(^^Ref, ref_members);
+    std::meta::define_aggregate(^^ConstRef, const_ref_members);
+  }
+};
+
+template<typename T>
+using SoARef = typename SoALayout<T>::Ref;
+template<typename T>
+using SoAConstRef = typename SoALayout<T>::ConstRef;
+
+/**
+ * Arena backed structure-of-arrays vector. Mirrors ArenaVec: grows by doubling into fresh arena
+ * memory and never frees, element access hands out SoARef proxies instead of T&.
+ */
+template<SoAComponent T>
+struct SoAVec {
+  using Layout = SoALayout<T>;
+
+  void* columns[Layout::count] = {};
+  U64   count                  = 0;
+  U64   cap                    = 0;
+  // Bytes of old columns left behind in the arena by grow()
+  U64 abandoned = 0;
+
+  template<typename Fn>
+  static void for_each_member(Fn&& fn) {
+    [&]<USize... I>(std::index_sequence<I...>) {
+      (fn.template operator()<I>(), ...);
+    }(std::make_index_sequence<Layout::count>{});
+  }
+
+  template<USize I>
+  typename Layout::template member_t<I>* column_data() const {
+    return static_cast<typename Layout::template member_t<I>*>(columns[I]);
+  }
+
+  // Dense column of one member, e.g. column<^^Renderable::view_mask>()
+  template<std::meta::info Member>
+  auto column() const {
+    constexpr USize I = Layout::template index_of<Member>();
+    static_assert(I < Layout::count, "Member does not belong to this component");
+    return std::span{column_data<I>(), count};
+  }
+
+  void push(Arena* arena, const T& item) {
+    if (count >= cap)
+      grow(arena, cap ? cap * 2 : 16);
+    store(count++, item);
+  }
+
+  void grow(Arena* arena, U64 new_cap) {
+    for_each_member([&]<USize I>() {
+      using M   = typename Layout::template member_t<I>;
+      M* column = arena->push_array_no_zero<M>(new_cap);
+      if (count)
+        std::memcpy(column, columns[I], count * sizeof(M));
+      if (columns[I])
+        abandoned += cap * sizeof(M);
+      columns[I] = column;
+    });
+    cap = new_cap;
+  }
+
+  void store(U64 i, const T& item) {
+    for_each_member([&]<USize I>() {
+      auto& dst = column_data<I>()[i];
+      std::memcpy(&dst, &Layout::template get<I>(item), sizeof(dst));
+    });
+  }
+
+  [[nodiscard]] T load(U64 i) const {
+    T item;
+    for_each_member([&]<USize I>() {
+      auto& dst = Layout::template get<I>(item);
+      std::memcpy(&dst, &column_data<I>()[i], sizeof(dst));
+    });
+    return item;
+  }
+
+  // Appends elements [first, first + n) of `src`, one memcpy per column
+  void append(Arena* arena, const SoAVec& src, U64 first, U64 n) {
+    if (count + n > cap)
+      grow(arena, max(count + n, cap * 2));
+    for_each_member([&]<USize I>() {
+      using M = typename Layout::template member_t<I>;
+      std::memcpy(column_data<I>() + count, src.template column_data<I>() + first, n * sizeof(M));
+    });
+    count += n;
+  }
+
+  void copy(U64 dst, U64 src) {
+    for_each_member([&]<USize I>() {
+      auto* column = column_data<I>();
+      std::memcpy(&column[dst], &column[src], sizeof(column[dst]));
+    });
+  }
+
+  void swap(U64 a, U64 b) {
+    for_each_member([&]<USize I>() {
+      auto*                                  column = column_data<I>();
+      typename Layout::template member_t<I> tmp;
+      std::memcpy(&tmp, &column[a], sizeof(tmp));
+      std::memcpy(&column[a], &column[b], sizeof(tmp));
+      std::memcpy(&column[b], &tmp, sizeof(tmp));
+    });
+  }
+
+  void clear() {
+    for (void*& column : columns)
+      column = nullptr;
+    count = 0;
+    cap   = 0;
+  }
+
+  SoARef<T> operator[](U64 i) {
+    return [&]<USize... I>(std::index_sequence<I...>) {
+      return SoARef<T>{column_data<I>()[i]...};
+    }(std::make_index_sequence<Layout::count>{});
+  }
+
+  SoAConstRef<T> operator[](U64 i) const {
+    return [&]<USize... I>(std::index_sequence<I...>) {
+      return SoAConstRef<T>{column_data<I>()[i]...};
+    }(std::make_index_sequence<Layout::count>{});
+  }
+};
+
+/**
+ * Storage selected for a component. Pools, views and EntityManager accessors use these aliases,
+ * so SoA components hand out SoARef proxies and std::optional<SoARef> where AoS ones hand out
+ * T& and T*. AoS components live in a PagedVec, so those pointers survive pool growth.
+ */
+template<typename T>
+struct ComponentStorage {
+  static_assert(!k_soa_component<T> || SoAComponent<T>,
+                "k_soa_component<T> is set but T is not trivially copyable and default "
+                "constructible, so it cannot be stored as columns");
+
+  using container       = PagedVec<T>;
+  using reference       = T&;
+  using const_reference = const T&;
+  using pointer         = T*;
+  using const_pointer   = const T*;
+};
+
+template<SoAComponent T>
+struct ComponentStorage<T> {
+  using container       = SoAVec<T>;
+  using reference       = SoARef<T>;
+  using const_reference = SoAConstRef<T>;
+  using pointer         = std::optional<SoARef<T>>;
+  using const_pointer   = std::optional<SoAConstRef<T>>;
+};
+
+template<typename T>
+using component_ref_t = typename ComponentStorage<T>::reference;
+template<typename T>
+using component_cref_t = typename ComponentStorage<T>::const_reference;
+template<typename T>
+using component_ptr_t = typename ComponentStorage<T>::pointer;
+template<typename T>
+using component_cptr_t = typename ComponentStorage<T>::const_pointer;
+
+} // namespace sd
@@ -1,50 +1,132 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <utility>
+
 #include "Entity.hpp"
 #include "SD/arena.hpp"
 #include "SD/core/arena_vec.hpp"
 #include "SD/core/math_utils.hpp"
+#include "SD/core/paged_vec.hpp"
 #include "SD/utils/serialization.hpp"
+#include "SoAStorage.hpp"
 #include "component_registration.hpp"
 
 namespace sd {
 
+inline constexpr USize SPARSE_PAGE_SIZE = 1024;
+inline constexpr U32   SPARSE_NONE      = g_type_max<U32>;
+
+// Read only page every untouched sparse slot points at, shared by all pools
+alignas(64) inline constexpr auto k_sparse_empty_page = [] {
+  std::array<U32, SPARSE_PAGE_SIZE> page{};
+  page.fill(SPARSE_NONE);
+  return page;
+}();
+
+// Memory held by one pool. Byte counts are arena bytes, not live data
+struct PoolStats {
+  U64 dense_count    = 0;
+  U64 dense_capacity = 0;
+  // Component data, entities and change tracking at capacity, block tables included
+  U64 dense_bytes = 0;
+  // Private pages, emptied ones kept for reuse included, and the page table
+  U64 sparse_pages   = 0;
+  U64 occupied_pages = 0;
+  U64 sparse_bytes   = 0;
+  // Old arrays left in the arena when growing moved them
+  U64 abandoned_bytes = 0;
+  // What compaction would keep, live entries and occupied pages
+  U64 live_bytes = 0;
+};
+
 template<typename T>
 struct SparseEntitySet {
-  static constexpr USize PAGE_SIZE = 1024;
+  static constexpr USize PAGE_SIZE = SPARSE_PAGE_SIZE;
   static constexpr USize SHIFT     = math::log2_int(PAGE_SIZE);
   static constexpr USize MASK      = PAGE_SIZE - 1;
 
+  using storage         = ComponentStorage<T>;
+  using reference       = typename storage::reference;
+  using const_reference = typename storage::const_reference;
+  using pointer         = typename storage::pointer;
+  using const_pointer   = typename storage::const_pointer;
+
   Arena* arena = nullptr;
 
-  USize** sparse_pages = nullptr;
-  U64     sparse_count = 0;
-  U64     sparse_cap   = 0;
+  // Dense index per entity index, SPARSE_NONE when absent. Pages without entries point at
+  // k_sparse_empty_page and are never written, page_counts tracks the live entries of a page.
+  U32** sparse_pages = nullptr;
+  U32*  page_counts  = nullptr;
+  U64   sparse_count = 0;
+  U64   sparse_cap   = 0;
+
+  // Emptied pages, already reset to SPARSE_NONE
+  ArenaVec<U32*> free_pages;
+
+  typename storage::container dense_data;
+  PagedVec<Entity>            dense_entities;
 
-  ArenaVec<T>      dense_data;
-  ArenaVec<Entity> dense_entities;
+  // Change tracking, off until enable_change_tracking(). changed_entities lists the entities marked
+  // since the last clear_changed(), dense_changed holds each slot's position in it or SPARSE_NONE
+  bool             track_changes = false;
+  PagedVec<U32>    dense_changed;
+  PagedVec<Entity> changed_entities;
 
+  // Bumped whenever entries move between dense slots, lets callers caching pointers revalidate
+  U64 reorder_count = 0;
+  // Page tables left behind by ensure_page() growth
+  U64 abandoned_table_bytes = 0;
+
+  static U32* empty_page() { return const_cast<U32*>(k_sparse_empty_page.data()); }
+
+  // Makes `page` writable, replacing the shared empty page with a private one
   void ensure_page(USize page) {
     if (page >= sparse_cap) {
       U64 new_cap = sparse_cap ? sparse_cap * 2 : 4;
       while (new_cap <= page)
         new_cap *= 2;
-      USize** new_pages = arena->push_array<USize*>(new_cap);
-      for (U64 i = 0; i < sparse_count; ++i)
-        new_pages[i] = sparse_pages[i];
+      U32** new_pages  = arena->push_array_no_zero<U32*>(new_cap);
+      U32*  new_counts = arena->push_array<U32>(new_cap);
+      abandoned_table_bytes += sparse_cap * (sizeof(U32*) + sizeof(U32));
+      for (U64 i = 0; i < sparse_count; ++i) {
+        new_pages[i]  = sparse_pages[i];
+        new_counts[i] = page_counts[i];
+      }
       for (U64 i = sparse_count; i < new_cap; ++i)
-        new_pages[i] = nullptr;
+        new_pages[i] = empty_page();
       sparse_pages = new_pages;
+      page_counts  = new_counts;
       sparse_cap   = new_cap;
     }
     if (page >= sparse_count)
       sparse_count = page + 1;
-    if (!sparse_pages[page]) {
-      sparse_pages[page] = arena->push_array<USize>(PAGE_SIZE);
-      for (USize i = 0; i < PAGE_SIZE; ++i)
-        sparse_pages[page][i] = std::numeric_limits<USize>::max();
+    if (sparse_pages[page] == empty_page()) {
+      if (free_pages.count > 0) {
+        sparse_pages[page] = free_pages[--free_pages.count];
+      } else {
+        sparse_pages[page] = arena->push_array_no_zero<U32>(PAGE_SIZE);
+        std::memset(sparse_pages[page], 0xFF, PAGE_SIZE * sizeof(U32));
+      }
     }
   }
 
+  // Called once an entry of `page` was reset to SPARSE_NONE
+  void release_entry(USize page) {
+    if (--page_counts[page] != 0)
+      return;
+    free_pages.push(arena, sparse_pages[page]);
+    sparse_pages[page] = empty_page();
+  }
+
+  U32 sparse_at(Entity entity) const {
+    USize page = entity.index >> SHIFT;
+    return page < sparse_count ? sparse_pages[page][entity.index & MASK] : SPARSE_NONE;
+  }
+
   template<typename... Args>
   void add(Entity entity, Args&&... args) {
     USize page   = entity.index >> SHIFT;
@@ -52,14 +134,108 @@ struct SparseEntitySet {
 
     ensure_page(page);
 
-    USize dense_idx = sparse_pages[page][offset];
-    if (dense_idx != std::numeric_limits<USize>::max()) {
-      dense_data[dense_idx]     = T{std::forward<Args>(args)...};
+    U32 dense_idx = sparse_pages[page][offset];
+    if (dense_idx != SPARSE_NONE) {
+      store(dense_idx, T{std::forward<Args>(args)...});
       dense_entities[dense_idx] = entity;
     } else {
-      sparse_pages[page][offset] = static_cast<USize>(dense_entities.count);
+      dense_idx                  = static_cast<U32>(dense_entities.count);
+      sparse_pages[page][offset] = dense_idx;
+      page_counts[page]++;
       dense_data.push(arena, T{std::forward<Args>(args)...});
       dense_entities.push(arena, entity);
+      if (track_changes)
+        dense_changed.push(arena, SPARSE_NONE);
+    }
+    mark_changed(dense_idx);
+  }
+
+  // Bulk add(). Sparse pages are prepared in the same pass, and runs of entities new to the set are
+  // appended with block sized copies
+  void add_many(std::span<const Entity> entities, std::span<const T> values) {
+    add_runs(
+        entities,
+        [&](USize i) -> const T& { return values[i]; },
+        [&](USize begin, USize n) {
+          if constexpr (SoAComponent<T>) {
+            for (USize i = begin; i < begin + n; ++i)
+              dense_data.push(arena, values[i]);
+          } else {
+            dense_data.append(arena, &values[begin], n);
+          }
+        });
+  }
+
+  // Bulk add() of one value for every entity, as instantiating a prefab does
+  void add_copies(std::span<const Entity> entities, const T& value) {
+    add_runs(
+        entities,
+        [&](USize) -> const T& { return value; },
+        [&](USize, USize n) {
+          if constexpr (SoAComponent<T>) {
+            for (USize i = 0; i < n; ++i)
+              dense_data.push(arena, value);
+          } else {
+            dense_data.fill(arena, value, n);
+          }
+        });
+  }
+
+  // Shared by the bulk adds. value_at(i) is the value for entities[i], append(begin, n) pushes the
+  // values of entities [begin, begin + n) to dense_data
+  template<typename ValueAt, typename Append>
+  void add_runs(std::span<const Entity> entities, ValueAt&& value_at, Append&& append) {
+    reserve(size() + entities.size());
+
+    USize run_begin = 0;
+    USize run_size  = 0;
+    auto  flush_run = [&] {
+      if (run_size == 0)
+        return;
+      dense_entities.append(arena, &entities[run_begin], run_size);
+      append(run_begin, run_size);
+      if (track_changes) {
+        for (USize i = 0; i < run_size; ++i) {
+          dense_changed.push(arena, SPARSE_NONE);
+          mark_changed(dense_entities.count - run_size + i);
+        }
+      }
+      run_size = 0;
+    };
+
+    for (USize i = 0; i < entities.size(); ++i) {
+      Entity entity = entities[i];
+      USize  page   = entity.index >> SHIFT;
+      ensure_page(page);
+
+      U32& slot = sparse_pages[page][entity.index & MASK];
+      if (slot != SPARSE_NONE) {
+        // Already present, possibly earlier in this batch
+        flush_run();
+        store(slot, value_at(i));
+        dense_entities[slot] = entity;
+        mark_changed(slot);
+        continue;
+      }
+      if (run_size == 0)
+        run_begin = i;
+      slot = static_cast<U32>(dense_entities.count + run_size);
+      page_counts[page]++;
+      run_size++;
+    }
+    flush_run();
+  }
+
+  // Makes room for `n` dense entries without further allocation
+  void reserve(USize n) {
+    dense_entities.reserve(arena, n);
+    if (track_changes)
+      dense_changed.reserve(arena, n);
+    if constexpr (SoAComponent<T>) {
+      if (n > dense_data.cap)
+        dense_data.grow(arena, n);
+    } else {
+      dense_data.reserve(arena, n);
     }
   }
 
@@ -67,11 +243,8 @@ struct SparseEntitySet {
     USize page   = entity.index >> SHIFT;
     USize offset = entity.index & MASK;
 
-    if (page >= sparse_count || !sparse_pages[page])
-      return false;
-
-    USize dense_idx = sparse_pages[page][offset];
-    if (dense_idx == std::numeric_limits<USize>::max())
+    U32 dense_idx = sparse_at(entity);
+    if (dense_idx == SPARSE_NONE)
       return false;
     if (dense_entities[dense_idx] != entity)
       return false;
@@ -79,64 +252,312 @@ struct SparseEntitySet {
     U64    last_idx    = dense_entities.count - 1;
     Entity last_entity = dense_entities[last_idx];
 
-    dense_data[dense_idx]     = dense_data[last_idx];
+    if (track_changes) {
+      unlist_changed(dense_idx);
+      dense_changed[dense_idx] = dense_changed[last_idx];
+      dense_changed.count--;
+    }
+
+    if constexpr (SoAComponent<T>)
+      dense_data.copy(dense_idx, last_idx);
+    else
+      dense_data[dense_idx] = dense_data[last_idx];
     dense_entities[dense_idx] = last_entity;
+    if (dense_idx != last_idx)
+      reorder_count++;
 
     USize last_page                      = last_entity.index >> SHIFT;
     USize last_offset                    = last_entity.index & MASK;
-    sparse_pages[last_page][last_offset] = static_cast<USize>(dense_idx);
+    sparse_pages[last_page][last_offset] = dense_idx;
 
-    sparse_pages[page][offset] = std::numeric_limits<USize>::max();
+    sparse_pages[page][offset] = SPARSE_NONE;
+    release_entry(page);
 
     dense_data.count--;
     dense_entities.count--;
     return true;
   }
 
-  T* get(Entity entity) {
-    USize page   = entity.index >> SHIFT;
-    USize offset = entity.index & MASK;
+  void enable_change_tracking() {
+    if (track_changes)
+      return;
+    track_changes = true;
+    dense_changed.reserve(arena, size());
+    for (USize i = 0; i < size(); ++i)
+      dense_changed.push(arena, SPARSE_NONE);
+  }
 
-    if (page >= sparse_count || !sparse_pages[page])
-      return nullptr;
+  // Lists the slot's entity in changed_entities, once per clear_changed()
+  void mark_changed(USize dense_idx) {
+    if (!track_changes || dense_changed[dense_idx] != SPARSE_NONE)
+      return;
+    dense_changed[dense_idx] = static_cast<U32>(changed_entities.count);
+    changed_entities.push(arena, dense_entities[dense_idx]);
+  }
 
-    USize dense_idx = sparse_pages[page][offset];
-    if (dense_idx == std::numeric_limits<USize>::max())
-      return nullptr;
-    if (dense_entities[dense_idx] != entity)
-      return nullptr;
+  // Swap-removes the slot's entity from changed_entities
+  void unlist_changed(USize dense_idx) {
+    U32 pos = dense_changed[dense_idx];
+    if (pos == SPARSE_NONE)
+      return;
+    U64 last = changed_entities.count - 1;
+    if (pos != last) {
+      Entity moved                    = changed_entities[last];
+      changed_entities[pos]           = moved;
+      dense_changed[sparse_at(moved)] = pos;
+    }
+    changed_entities.count--;
+    dense_changed[dense_idx] = SPARSE_NONE;
+  }
 
-    return &dense_data[dense_idx];
+  // Costs one write per listed entity, not per entity in the set
+  void clear_changed() {
+    for (U64 i = 0; i < changed_entities.count; ++i)
+      dense_changed[sparse_at(changed_entities[i])] = SPARSE_NONE;
+    // Keep the blocks, the list refills every frame
+    changed_entities.count = 0;
   }
 
-  const T* get(Entity entity) const {
-    USize page   = entity.index >> SHIFT;
-    USize offset = entity.index & MASK;
+  const PagedVec<Entity>& get_changed_entities() const { return changed_entities; }
+
+  // Position of the entity in the dense arrays, or max() when it is not in the set
+  USize dense_index(Entity entity) const {
+    U32 dense_idx = sparse_at(entity);
+    if (dense_idx == SPARSE_NONE || dense_entities[dense_idx] != entity)
+      return std::numeric_limits<USize>::max();
+    return dense_idx;
+  }
 
-    if (page >= sparse_count || !sparse_pages[page])
-      return nullptr;
+  pointer get(Entity entity) {
+    USize dense_idx = dense_index(entity);
+    if (dense_idx == std::numeric_limits<USize>::max())
+      return pointer{};
+    if constexpr (SoAComponent<T>)
+      return pointer{dense_data[dense_idx]};
+    else
+      return &dense_data[dense_idx];
+  }
 
-    USize dense_idx = sparse_pages[page][offset];
+  const_pointer get(Entity entity) const {
+    USize dense_idx = dense_index(entity);
     if (dense_idx == std::numeric_limits<USize>::max())
-      return nullptr;
-    if (dense_entities[dense_idx] != entity)
-      return nullptr;
+      return const_pointer{};
+    if constexpr (SoAComponent<T>)
+      return const_pointer{dense_data[dense_idx]};
+    else
+      return &dense_data[dense_idx];
+  }
+
+  // Value copies, for code that needs a whole T regardless of the storage layout
+  T load(USize dense_idx) const {
+    if constexpr (SoAComponent<T>)
+      return dense_data.load(dense_idx);
+    else
+      return dense_data[dense_idx];
+  }
+
+  void store(USize dense_idx, const T& value) {
+    if constexpr (SoAComponent<T>)
+      dense_data.store(dense_idx, value);
+    else
+      dense_data[dense_idx] = value;
+  }
+
+  // Swaps two dense slots and patches their sparse entries. Used to keep owning groups packed
+  void swap_dense(USize a, USize b) {
+    if (a == b)
+      return;
+    reorder_count++;
+    if constexpr (SoAComponent<T>)
+      dense_data.swap(a, b);
+    else
+      std::swap(dense_data[a], dense_data[b]);
+    std::swap(dense_entities[a], dense_entities[b]);
+    if (track_changes)
+      std::swap(dense_changed[a], dense_changed[b]);
+
+    Entity ea = dense_entities[a];
+    Entity eb = dense_entities[b];
+    sparse_pages[ea.index >> SHIFT][ea.index & MASK] = static_cast<U32>(a);
+    sparse_pages[eb.index >> SHIFT][eb.index & MASK] = static_cast<U32>(b);
+  }
+
+  /**
+   * Orders the dense range [begin, end) by less(const_reference, const_reference), moving
+   * components, entities and sparse entries together. Data that is nearly sorted, like a list
+   * sorted last frame with a few changes, takes an insertion sort path with a bounded number of
+   * swaps. Anything else sorts a permutation in thread scratch and applies it one cycle at a time. Returns whether any entry
+   * moved, already sorted ranges are left untouched.
+   */
+  template<typename Compare>
+  bool sort(Compare&& less, USize begin = 0, USize end = std::numeric_limits<USize>::max()) {
+    end = std::min(end, size());
+    if (end - begin < 2)
+      return false;
+
+    auto at = [this](USize i) -> const_reference { return std::as_const(dense_data)[i]; };
+
+    USize descents = 0;
+    for (USize i = begin + 1; i < end; ++i)
+      descents += less(at(i), at(i - 1));
+    if (descents == 0)
+      return false;
+
+    if (descents <= (end - begin) / 32) {
+      // Few descents can still hide many inversions, like a rotated range. Once the swaps run past
+      // a few per entry the permutation path below finishes from wherever this pass stopped
+      USize budget = 4 * (end - begin);
+      for (USize i = begin + 1; i < end && budget > 0; ++i) {
+        for (USize j = i; j > begin && budget > 0 && less(at(j), at(j - 1)); --j, --budget)
+          swap_dense(j, j - 1);
+      }
+      if (budget > 0)
+        return true;
+    }
+
+    // perm[i] is the slot whose entry belongs at begin + i. Scratch rather than the pool arena,
+    // which other pools and managers may be pushing into
+    Temp  scratch = scratch_begin(arena);
+    USize count   = end - begin;
+    U32*  perm    = scratch.arena->push_array_no_zero<U32>(count);
+    for (USize i = 0; i < count; ++i)
+      perm[i] = static_cast<U32>(begin + i);
+    std::sort(perm, perm + count, [&](U32 a, U32 b) { return less(at(a), at(b)); });
+
+    // Each swap settles one slot, the last slot of a cycle receives the entry from its start
+    for (USize i = 0; i < count; ++i) {
+      const USize start = begin + i;
+      USize       slot  = start;
+      while (true) {
+        USize next         = perm[slot - begin];
+        perm[slot - begin] = static_cast<U32>(slot);
+        if (next == start)
+          break;
+        swap_dense(slot, next);
+        slot = next;
+      }
+    }
+    scratch_end(scratch);
+    return true;
+  }
+
+  // Moves the entities this set shares with `other` to the front, in the order `other` has them
+  template<typename U>
+  void sort_as(const SparseEntitySet<U>& other) {
+    USize pos = 0;
+    for (USize i = 0; i < other.size(); ++i) {
+      // Entities placed so far are all in [0, pos), so idx is never below pos
+      USize idx = dense_index(other.dense_entities[i]);
+      if (idx != std::numeric_limits<USize>::max())
+        swap_dense(idx, pos++);
+    }
+  }
 
-    return &dense_data[dense_idx];
+  // No page or generation checks, the caller guarantees the entity is in the set (e.g. its
+  // component mask was already tested).
+  reference get_unchecked(Entity entity) {
+    return dense_data[sparse_pages[entity.index >> SHIFT][entity.index & MASK]];
+  }
+  const_reference get_unchecked(Entity entity) const {
+    return dense_data[sparse_pages[entity.index >> SHIFT][entity.index & MASK]];
   }
 
-  T* operator[](Entity idx) { return get(idx); }
+  pointer operator[](Entity idx) { return get(idx); }
 
-  const ArenaVec<Entity>& get_dense_entities() const { return dense_entities; }
+  const PagedVec<Entity>& get_dense_entities() const { return dense_entities; }
 
   USize size() const { return static_cast<USize>(dense_entities.count); }
 
+  // Moves the entries of `other` into this empty set, keeping the dense order. Arrays are sized to
+  // the live entries and only pages holding entries are allocated, so `arena` receives no waste
+  void compact_from(SparseEntitySet& other) {
+    const USize n = other.size();
+
+    USize pages = 0;
+    for (USize p = 0; p < other.sparse_count; ++p) {
+      if (other.page_counts[p] != 0)
+        pages = p + 1;
+    }
+    if (pages > 0) {
+      sparse_pages = arena->push_array_no_zero<U32*>(pages);
+      page_counts  = arena->push_array<U32>(pages);
+      sparse_count = pages;
+      sparse_cap   = pages;
+      for (USize p = 0; p < pages; ++p) {
+        sparse_pages[p] = empty_page();
+        if (other.page_counts[p] == 0)
+          continue;
+        // Dense order is kept, so every dense index in the page is still right
+        sparse_pages[p] = arena->push_array_no_zero<U32>(PAGE_SIZE);
+        std::memcpy(sparse_pages[p], other.sparse_pages[p], PAGE_SIZE * sizeof(U32));
+        page_counts[p] = other.page_counts[p];
+      }
+    }
+
+    dense_entities.move_from(arena, other.dense_entities);
+    if constexpr (SoAComponent<T>) {
+      dense_data.append(arena, other.dense_data, 0, n);
+    } else {
+      dense_data.move_from(arena, other.dense_data);
+    }
+
+    track_changes = other.track_changes;
+    if (track_changes) {
+      dense_changed.move_from(arena, other.dense_changed);
+      changed_entities.move_from(arena, other.changed_entities);
+    }
+    // Every entry moved to new memory, callers caching pointers must refresh them
+    reorder_count = other.reorder_count + 1;
+  }
+
+  // Walks the page table, cheap enough for a debug panel but not for every frame of a hot loop
+  PoolStats stats() const {
+    PoolStats stats{};
+    stats.dense_count = size();
+
+    auto paged_bytes = [](const auto& vec) {
+      using Elem = std::remove_cvref_t<decltype(vec[0])>;
+      return vec.capacity() * sizeof(Elem) + vec.blocks.cap * sizeof(Elem*);
+    };
+    if constexpr (SoAComponent<T>) {
+      stats.dense_capacity = dense_data.cap;
+      stats.dense_bytes    = dense_data.cap * sizeof(T);
+      stats.abandoned_bytes += dense_data.abandoned;
+    } else {
+      stats.dense_capacity = dense_data.capacity();
+      stats.dense_bytes    = paged_bytes(dense_data);
+      stats.abandoned_bytes += dense_data.blocks.abandoned;
+    }
+    stats.dense_bytes += paged_bytes(dense_entities) + paged_bytes(dense_changed) +
+                         paged_bytes(changed_entities);
+    stats.abandoned_bytes += dense_entities.blocks.abandoned + dense_changed.blocks.abandoned +
+                             changed_entities.blocks.abandoned + free_pages.abandoned +
+                             abandoned_table_bytes;
+
+    for (U64 i = 0; i < sparse_count; ++i) {
+      if (sparse_pages[i] != empty_page())
+        stats.occupied_pages++;
+    }
+    stats.sparse_pages = stats.occupied_pages + free_pages.count;
+    stats.live_bytes   = stats.dense_count * (sizeof(T) + sizeof(Entity)) +
+                       stats.occupied_pages * PAGE_SIZE * sizeof(U32);
+    stats.sparse_bytes = stats.sparse_pages * PAGE_SIZE * sizeof(U32) +
+                         sparse_cap * (sizeof(U32*) + sizeof(U32)) + free_pages.cap * sizeof(U32*);
+    return stats;
+  }
+
   void clear() {
-    sparse_pages = nullptr;
-    sparse_count = 0;
-    sparse_cap   = 0;
+    sparse_pages          = nullptr;
+    page_counts           = nullptr;
+    sparse_count          = 0;
+    sparse_cap            = 0;
+    abandoned_table_bytes = 0;
+    free_pages.clear();
     dense_data.clear();
     dense_entities.clear();
+    track_changes = false;
+    dense_changed.clear();
+    changed_entities.clear();
   }
 
   void serialize_to(std::vector<char>& out) const {
@@ -150,9 +571,13 @@ struct SparseEntitySet {
     memcpy(ptr, &comp_size, sizeof(size_t));
     ptr += sizeof(size_t);
 
-    memcpy(ptr, dense_entities.data, entity_count * sizeof(Entity));
+    for (size_t i = 0; i < entity_count; ++i)
+      memcpy(ptr + i * sizeof(Entity), &dense_entities[i], sizeof(Entity));
     ptr += entity_count * sizeof(Entity);
-    memcpy(ptr, dense_data.data, entity_count * comp_size);
+    for (size_t i = 0; i < entity_count; ++i) {
+      T comp = load(i);
+      memcpy(ptr + i * comp_size, &comp, comp_size);
+    }
   }
 
   void deserialize_from(const std::vector<char>& data) {
@@ -189,7 +614,7 @@ struct SparseEntitySet {
     }
     if constexpr (SerializableComponent<T>) {
       for (U64 i = 0; i < dense_data.count; ++i) {
-        ComponentSerializer<T>::serialize(dense_data[i], s);
+        ComponentSerializer<T>::serialize(load(i), s);
       }
     }
   }
@@ -214,7 +639,8 @@ struct SparseEntitySet {
       USize  page   = e.index >> SHIFT;
       USize  offset = e.index & MASK;
       ensure_page(page);
-      sparse_pages[page][offset] = static_cast<USize>(i);
+      sparse_pages[page][offset] = static_cast<U32>(i);
+      page_counts[page]++;
     }
   }
 
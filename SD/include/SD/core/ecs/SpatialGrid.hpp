@@ -0,0 +1,159 @@
+#pragma once
+#include <VLA/Matrix.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+
+#include "EntityManager.hpp"
+#include "SD/arena.hpp"
+#include "SD/core/JobSystem.hpp"
+#include "SD/core/arena_vec.hpp"
+#include "components.hpp"
+
+namespace sd {
+
+/**
+ * Spatial index over the translation of Transform::world_matrix, for radius, box and ray queries
+ * without scanning every entity.
+ *
+ * A loose uniform grid: each entity lives in the one cell holding its center, with its
+ * BoundingSphere radius (0 without one). Radii up to the cell size are allowed in cells, so
+ * queries widen their cell range by one cell. Wider spheres go to a separate oversized list that
+ * every query tests, which keeps a few huge objects from widening the search for all others.
+ * Cells only list entities, the spheres are stored per entity index. Queries gather a cell's
+ * spheres into fixed size batches and test them without branches, so the compiler vectorizes the
+ * rejection, and only the hits of a batch are branched on.
+ *
+ * Only entities whose Transform or BoundingSphere changed are re-bucketed by update(), read from
+ * the pools' change lists, so call it after transforms are written and before clear_changes().
+ * Re-bucketing runs in two passes: a parallel one reads every changed entity through the pools'
+ * dense indices and writes its sphere, then a serial one moves the few that crossed into another
+ * cell. Cells emptied by moves are recycled, so the grid does not grow as entities wander. Removal
+ * follows the Destroy observers, which the destructor unregisters.
+ */
+template<typename ExtraComponents>
+struct SpatialGrid {
+  using manager_type = EntityManager<ExtraComponents>;
+
+  static constexpr U32   NO_CELL   = g_type_max<U32>;
+  static constexpr U32   OVERSIZED = NO_CELL - 1;
+  static constexpr USize BATCH     = 8;
+
+  SpatialGrid(manager_type& manager, Arena* arena, F32 cell_size = 4.0f);
+  ~SpatialGrid();
+
+  SpatialGrid(const SpatialGrid&)            = delete;
+  SpatialGrid& operator=(const SpatialGrid&) = delete;
+
+  // Splits the re-bucketing of large change lists over `jobs` in chunks of `grain` entities
+  void update(JobSystem* jobs = nullptr, USize grain = 4096);
+
+  // Results live in `out`, usually the frame arena
+  std::span<Entity> query_aabb(const VLA::Vector3f& min, const VLA::Vector3f& max, Arena* out);
+  std::span<Entity> query_radius(const VLA::Vector3f& center, F32 radius, Arena* out);
+  // Entities whose bounds the ray enters within max_distance, nearest first. `dir` is normalized
+  std::span<Entity> raycast(const VLA::Vector3f& origin,
+                            const VLA::Vector3f& dir,
+                            F32                  max_distance,
+                            Arena*               out);
+
+  [[nodiscard]] USize size() const { return m_size; }
+  // Cells holding at least one entity
+  [[nodiscard]] USize cell_count() const { return m_cells.count - m_free_cells.count; }
+  [[nodiscard]] USize oversized_count() const { return m_oversized.entities.count; }
+
+  struct CellKey {
+    I32 x, y, z;
+
+    bool operator==(const CellKey&) const = default;
+  };
+
+  struct Sphere {
+    F32 x, y, z, radius;
+  };
+
+  // The sphere of row i is m_spheres[entities[i].index]
+  struct Cell {
+    CellKey          key;
+    U32              stamp = 0;
+    ArenaVec<Entity> entities;
+  };
+
+  // Keys are kept in the table so a probe touches no cell, cell is NO_CELL for empty buckets
+  struct Bucket {
+    CellKey key{};
+    U32     cell = NO_CELL;
+  };
+
+  // Where an entity index is stored, cell is NO_CELL when it is not in the grid and OVERSIZED in
+  // m_oversized. The key is kept so an entity staying in its cell is updated without a lookup
+  struct Slot {
+    CellKey key{};
+    U32     cell = NO_CELL;
+    U32     row  = 0;
+  };
+
+  struct Hit {
+    F32    distance;
+    Entity entity;
+  };
+
+  // Result of the parallel pass of rebucket() for one entity
+  struct Placement {
+    CellKey key;
+    bool    moves;
+  };
+
+  static U64 hash_of(const CellKey& key);
+  CellKey    key_of(F32 x, F32 y, F32 z) const;
+  U32        find_cell(const CellKey& key) const;
+  U32        ensure_cell(const CellKey& key);
+  // Drops an emptied cell from the table and keeps it for reuse by ensure_cell()
+  void       release_cell(U32 cell);
+  void       grow_table();
+  Cell&      cell_at(U32 cell) { return cell == OVERSIZED ? m_oversized : m_cells[cell]; }
+
+  // Re-buckets `entities`, the placements live in `scratch`
+  void rebucket(std::span<const Entity> entities, Arena* scratch, JobSystem* jobs, USize grain);
+  // Moves `e` out of its current cell, if any, into the cell of `key` or m_oversized
+  void relink(Entity e, const CellKey& key, bool oversized);
+  void unlink(Entity e);
+  // Runs test(sphere) over the rows in batches, fn(row) is called for every row it accepted
+  template<typename Test, typename Fn>
+  void overlap_rows(const Cell& cell, Test&& test, Fn&& fn) const;
+  template<typename Fn>
+  void overlap_sphere(const Cell& cell, F32 cx, F32 cy, F32 cz, F32 radius, Fn&& fn) const;
+  template<typename Fn>
+  void overlap_box(const Cell&          cell,
+                   const VLA::Vector3f& min,
+                   const VLA::Vector3f& max,
+                   Fn&&                 fn) const;
+  // Calls fn(cell) for every cell whose key is in [lo, hi]
+  template<typename Fn>
+  void for_cells(const CellKey& lo, const CellKey& hi, Fn&& fn);
+
+  static void on_transform_destroyed(void* self, Entity e);
+  static void on_bounds_destroyed(void* self, Entity e);
+
+  manager_type& m_manager;
+  Arena*        m_arena = nullptr;
+  F32           m_cell_size;
+  F32           m_inv_cell_size;
+
+  ArenaVec<Cell>   m_cells;
+  // Emptied cells, out of the table and reused before new ones are pushed
+  ArenaVec<U32>    m_free_cells;
+  // Spheres wider than a cell, tested by every query. The key is unused
+  Cell             m_oversized;
+  // Open addressed with linear probing, power of two sized
+  ArenaVec<Bucket> m_table;
+  // Both indexed by entity index
+  ArenaVec<Slot>   m_slots;
+  ArenaVec<Sphere> m_spheres;
+  USize            m_size  = 0;
+  U32              m_stamp = 0;
+};
+
+#include "impl/SpatialGrid.inl"
+} // namespace sd
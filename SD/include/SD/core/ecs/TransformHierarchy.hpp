@@ -0,0 +1,84 @@
+#pragma once
+#include <VLA/Matrix.hpp>
+#include <algorithm>
+
+#include "EntityManager.hpp"
+#include "SD/arena.hpp"
+#include "SD/core/JobSystem.hpp"
+#include "SD/core/arena_vec.hpp"
+#include "components.hpp"
+
+namespace sd {
+
+/**
+ * Propagates LocalTransform through the Parent/Children hierarchy into Transform::world_matrix.
+ *
+ * Nodes are kept in breadth-first order, so a parent always precedes its children and every depth
+ * is one contiguous range. World matrices live in a dense array in that order, which makes
+ * propagation one linear pass reading the parent's matrix by index. Only subtrees below a changed
+ * LocalTransform are multiplied again, and wide levels are split across the job system.
+ *
+ * An entity joins the hierarchy with both LocalTransform and Transform, one without them ends its
+ * branch. The order is rebuilt after structural changes, which the hierarchy learns about through
+ * component observers. They are removed again on destruction.
+ */
+template<typename ExtraComponents>
+struct TransformHierarchy {
+  using manager_type = EntityManager<ExtraComponents>;
+
+  static constexpr U32 NO_NODE = g_type_max<U32>;
+
+  TransformHierarchy(manager_type& manager, Arena* arena);
+  ~TransformHierarchy();
+
+  TransformHierarchy(const TransformHierarchy&)            = delete;
+  TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+  // Attaches `child` under `parent`, or detaches it when `parent` is the null entity
+  void set_parent(Entity child, Entity parent);
+
+  // Call once per frame, before clear_changes() drops the LocalTransform change list
+  void propagate(JobSystem* jobs = nullptr, USize grain = 512);
+  // Rebuilds on the next propagate(), needed once compact() moved the manager's pools
+  void mark_dirty() { m_order_dirty = true; }
+
+  [[nodiscard]] USize node_count() const { return m_nodes.count; }
+  [[nodiscard]] USize depth() const { return m_levels.count ? m_levels.count - 1 : 0; }
+
+  // `parent` is the parent's node slot, NO_NODE for roots
+  struct Node {
+    Entity                            entity;
+    U32                               parent;
+    components::Transform*            world;
+    const components::LocalTransform* local;
+  };
+
+  void rebuild();
+  // Refreshes cached component pointers after either pool moved entries between dense slots
+  void refresh_pointers();
+  void update_range(USize begin, USize end);
+  [[nodiscard]] bool is_ancestor(Entity ancestor, Entity e) const;
+
+  static void on_structure_changed(void* self, Entity e);
+  static void on_parent_removed(void* self, Entity e);
+
+  manager_type& m_manager;
+  Arena*        m_arena = nullptr;
+
+  ArenaVec<Node>            m_nodes;
+  ArenaVec<VLA::Matrix4x4f> m_world;
+  ArenaVec<U8>              m_dirty;
+  // Start of each depth in m_nodes, followed by m_nodes.count
+  ArenaVec<U32> m_levels;
+  // Node slot per entity index, NO_NODE when the entity is not in the hierarchy
+  ArenaVec<U32> m_slot_of;
+
+  // Pool reorder counts the cached pointers were taken at
+  U64 m_local_reorders     = 0;
+  U64 m_transform_reorders = 0;
+
+  bool m_order_dirty = true;
+};
+
+#include "impl/TransformHierarchy.inl"
+} // namespace sd
@@ -3,6 +3,7 @@
 #include "CommandQueue.hpp"
 #include "Entity.hpp"
 #include "EntityManager.hpp"
+#include "Prefab.hpp"
 #include "components.hpp"
 
 namespace sd {
@@ -11,7 +12,8 @@ struct CreateEntityCmd {
   EntityHandle m_handle;
   Entity       m_created_entity = {};
 
-  void execute(EntityManager<ComponentGroup<>>& em, CommandQueue& queue) {
+  template<typename Manager>
+  void execute(Manager& em, CommandQueue& queue) {
     m_created_entity = em.create();
     queue.set_entity_for_handle(m_handle, m_created_entity);
   }
@@ -19,10 +21,60 @@ struct CreateEntityCmd {
   void deserialize(Serializer& serializer) { m_handle.id = serializer.read<U32>(); }
 };
 
+// Creates m_count entities with create_many(), bound to consecutive handles from m_first_handle
+struct CreateEntitiesCmd {
+  EntityHandle m_first_handle;
+  U32          m_count = 0;
+
+  template<typename Manager>
+  void execute(Manager& em, CommandQueue& queue) {
+    Entity* created = queue.arena()->push_array_no_zero<Entity>(m_count);
+    em.create_many(std::span{created, m_count});
+    for (U32 i = 0; i < m_count; ++i)
+      queue.set_entity_for_handle(EntityHandle{m_first_handle.id + i}, created[i]);
+  }
+  void serialize(Serializer& serializer) const {
+    serializer.write(m_first_handle.id);
+    serializer.write(m_count);
+  }
+  void deserialize(Serializer& serializer) {
+    m_first_handle.id = serializer.read<U32>();
+    m_count           = serializer.read<U32>();
+  }
+};
+
+// Instantiates m_prefab m_count times, bound to consecutive handles from m_first_handle. The
+// prefab's blob is shared with the caller and must outlive apply(). Deserializing copies it into
+// the queue arena
+struct AddPrefabCmd {
+  EntityHandle m_first_handle;
+  U32          m_count = 0;
+  Prefab       m_prefab;
+
+  template<typename Manager>
+  void execute(Manager& em, CommandQueue& queue) {
+    Entity* created = queue.arena()->push_array_no_zero<Entity>(m_count);
+    em.instantiate(m_prefab, std::span{created, m_count});
+    for (U32 i = 0; i < m_count; ++i)
+      queue.set_entity_for_handle(EntityHandle{m_first_handle.id + i}, created[i]);
+  }
+  void serialize(Serializer& serializer) const {
+    serializer.write(m_first_handle.id);
+    serializer.write(m_count);
+    m_prefab.serialize(serializer);
+  }
+  void deserialize(Serializer& serializer) {
+    m_first_handle.id = serializer.read<U32>();
+    m_count           = serializer.read<U32>();
+    m_prefab.deserialize(serializer);
+  }
+};
+
 struct DestroyEntityCmd {
   Entity m_entity;
 
-  void execute(EntityManager<ComponentGroup<>>& em, CommandQueue&) { em.destroy(m_entity); }
+  template<typename Manager>
+  void execute(Manager& em, CommandQueue&) { em.destroy(m_entity); }
   void serialize(Serializer& serializer) const {
     serializer.write<U32>(m_entity.index);
     serializer.write<U32>(m_entity.generation);
@@ -41,9 +93,10 @@ struct AddComponentCmd {
   AddComponentCmd() = default;
   AddComponentCmd(EntityHandle handle, T data) : m_handle(handle), m_data(data) {}
 
-  void execute(EntityManager<ComponentGroup<>>& em, CommandQueue& queue) {
+  template<typename Manager>
+  void execute(Manager& em, CommandQueue& queue) {
     Entity e = queue.get_entity(m_handle);
-    em.add_component<T>(e, m_data);
+    em.template add_component<T>(e, m_data);
   }
 
   void serialize(Serializer& serializer) const {
@@ -63,9 +116,10 @@ struct RemoveComponentCmd {
 
   explicit RemoveComponentCmd(EntityHandle handle) : m_handle(handle) {}
 
-  void execute(EntityManager<ComponentGroup<>>& em, CommandQueue& queue) {
+  template<typename Manager>
+  void execute(Manager& em, CommandQueue& queue) {
     Entity e = queue.get_entity(m_handle);
-    em.try_remove_component<T>(e);
+    em.template try_remove_component<T>(e);
   }
   void serialize(Serializer& serializer) const { serializer.write(m_handle.id); }
   void deserialize(Serializer& serializer) { m_handle.id = serializer.read<U32>(); }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <meta>
+#include <type_traits>
 
 #include "SD/core/types.hpp"
 #include "SD/utils/FixedString.hpp"
@@ -29,6 +30,12 @@ struct ConcatComponentGroups<ComponentGroup<As...>, ComponentGroup<Bs...>> {
 template<typename A, typename B>
 using ConcatComponentGroups_t = typename ConcatComponentGroups<A, B>::type;
 
+template<typename Group>
+struct ComponentGroupSize;
+
+template<typename... Ts>
+struct ComponentGroupSize<ComponentGroup<Ts...>> : std::integral_constant<USize, sizeof...(Ts)> {};
+
 template<typename Group>
 struct IsUniqueComponentGroup;
 
@@ -64,6 +71,14 @@ struct ComponentSerializer {
   static void deserialize(T& component, Serializer& s)     = delete;
 };
 
+// Empty components are tags, EntityManager keeps them as mask bits without a pool
+template<typename T>
+concept TagComponent = std::is_empty_v<T>;
+
+// Shared instance handed out by accessors for tags, it has no state to get wrong
+template<TagComponent T>
+inline T g_tag_instance{};
+
 template<typename T>
 concept SerializableComponent = requires(T& t, Serializer& s) {
   ComponentSerializer<T>::serialize(t, s);
@@ -2,7 +2,10 @@
 #include <VLA/Matrix.hpp>
 
 #include "ComponentFactory.hpp"
+#include "Entity.hpp"
+#include "Prefab.hpp"
 #include "SD/core/types.hpp"
+#include "SoAStorage.hpp"
 #include "component_registration.hpp"
 
 namespace sd::components {
@@ -60,6 +63,28 @@ struct Renderable {
 //   }
 // };
 
+// Transform relative to the Parent, TransformHierarchy writes the product into Transform
+struct LocalTransform {
+  VLA::Matrix4x4f matrix;
+};
+
+// Links are maintained by TransformHierarchy::set_parent, do not edit them directly
+struct Parent {
+  Entity entity{};
+  Entity prev_sibling{};
+  Entity next_sibling{};
+};
+
+struct Children {
+  Entity first{};
+  U32    count = 0;
+};
+
+// Extent around the Transform translation, used by SpatialGrid. Entities without one are points
+struct BoundingSphere {
+  F32 radius = 0.0f;
+};
+
 // TODO(vatnar): this shouldnt be a string, rather a non owning slice (arena strings etc)
 struct DebugName {
   std::string name;
@@ -73,5 +98,25 @@ struct DebugName {
 
 // ComponentGroup of ordered engine components, should not be redefined for any case. Things will
 // break.
-using EngineComponents = ComponentGroup<Transform, Camera, Renderable, DebugName>;
+using EngineComponents = ComponentGroup<Transform,
+                                        Camera,
+                                        Renderable,
+                                        DebugName,
+                                        LocalTransform,
+                                        Parent,
+                                        Children,
+                                        BoundingSphere>;
 } // namespace sd::components
+
+namespace sd {
+// Render loops filter on view_mask and render_stage before touching anything else
+template<>
+inline constexpr bool k_soa_component<components::Renderable> = true;
+
+// Hierarchy links name the captured entity's parent and siblings. Prefab copies start as roots and
+// are attached with TransformHierarchy::set_parent
+template<>
+inline constexpr bool k_prefab_component<components::Parent> = false;
+template<>
+inline constexpr bool k_prefab_component<components::Children> = false;
+} // namespace sd
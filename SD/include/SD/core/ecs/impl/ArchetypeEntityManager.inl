@@ -0,0 +1,512 @@
+#pragma once
+
+template<typename ExtraComponents, typename... Components>
+bool ArchetypeView<ExtraComponents, Components...>::matches(const archetype_type& archetype) const {
+  using Mask = typename manager_type::ComponentMask;
+  static constexpr Mask required =
+      Mask::from_ids({manager_type::template component_info<Components>::id()...});
+  return archetype.entity_count != 0 && archetype.mask.contains(required);
+}
+
+template<typename ExtraComponents, typename... Components>
+void ArchetypeView<ExtraComponents, Components...>::Iterator::settle() {
+  const auto& archetypes = view->m_manager.m_archetypes;
+  while (archetype < archetypes.count && !view->matches(*archetypes[archetype])) {
+    ++archetype;
+    chunk = 0;
+    row   = 0;
+  }
+}
+
+template<typename ExtraComponents, typename... Components>
+typename ArchetypeView<ExtraComponents, Components...>::Iterator&
+ArchetypeView<ExtraComponents, Components...>::Iterator::operator++() {
+  const archetype_type& current = *view->m_manager.m_archetypes[archetype];
+  if (++row < manager_type::chunk_header(current.chunks[chunk])->count)
+    return *this;
+
+  row = 0;
+  if (++chunk < current.chunks.count)
+    return *this;
+
+  chunk = 0;
+  ++archetype;
+  settle();
+  return *this;
+}
+
+template<typename ExtraComponents, typename... Components>
+std::tuple<Entity, Components&...>
+ArchetypeView<ExtraComponents, Components...>::Iterator::operator*() const {
+  const archetype_type& current = *view->m_manager.m_archetypes[archetype];
+  U8*                   data    = current.chunks[chunk];
+  return std::tuple<Entity, Components&...>(
+      manager_type::chunk_entities(data)[row],
+      *static_cast<Components*>(manager_type::column_ptr(
+          current, data, manager_type::template component_info<Components>::id(), row))...);
+}
+
+template<typename ExtraComponents, typename... Components>
+typename ArchetypeView<ExtraComponents, Components...>::Iterator
+ArchetypeView<ExtraComponents, Components...>::begin() const {
+  Iterator it{this, 0, 0, 0};
+  it.settle();
+  return it;
+}
+
+template<typename ExtraComponents, typename... Components>
+typename ArchetypeView<ExtraComponents, Components...>::Iterator
+ArchetypeView<ExtraComponents, Components...>::end() const {
+  return Iterator{this, m_manager.m_archetypes.count, 0, 0};
+}
+
+template<typename ExtraComponents, typename... Components>
+template<typename Fn>
+void ArchetypeView<ExtraComponents, Components...>::each(Fn&& fn) const {
+  for (archetype_type* archetype : m_manager.m_archetypes) {
+    if (!matches(*archetype))
+      continue;
+    for (U8* data : archetype->chunks) {
+      const U32     count    = manager_type::chunk_header(data)->count;
+      const Entity* entities = manager_type::chunk_entities(data);
+      std::tuple<Components*...> columns{static_cast<Components*>(manager_type::column_ptr(
+          *archetype, data, manager_type::template component_info<Components>::id(), 0))...};
+      for (U32 row = 0; row < count; ++row)
+        fn(entities[row], std::get<Components*>(columns)[row]...);
+    }
+  }
+}
+
+template<typename ExtraComponents>
+template<typename Fn>
+void ArchetypeEntityManager<ExtraComponents>::dispatch_component(USize id, Fn&& fn) {
+  [&]<typename... Ts>(ComponentGroup<Ts...>) {
+    USize index = 0;
+    ((index++ == id ? (fn.template operator()<Ts>(), true) : false) || ...);
+  }(all_components{});
+}
+
+template<typename ExtraComponents>
+typename ArchetypeEntityManager<ExtraComponents>::archetype_type*
+ArchetypeEntityManager<ExtraComponents>::find_or_create_archetype(const ComponentMask& mask) {
+  for (archetype_type* archetype : m_archetypes) {
+    if (archetype->mask == mask)
+      return archetype;
+  }
+
+  auto* archetype = arena_push<archetype_type>(m_pool_arena);
+  archetype->mask = mask;
+
+  USize row_size = sizeof(Entity);
+  for (USize id = 0; id < COMPONENT_COUNT; ++id) {
+    archetype->column_offset[id] = archetype_type::NO_COLUMN;
+    if (mask.test(id))
+      row_size += s_layouts[id].size;
+  }
+
+  // Start from the unpadded estimate and shrink until the aligned columns fit in one chunk
+  U32 capacity = static_cast<U32>((CHUNK_SIZE - CHUNK_HEADER_SIZE) / row_size);
+  for (; capacity > 0; --capacity) {
+    USize offset = CHUNK_HEADER_SIZE + sizeof(Entity) * capacity;
+    for (USize id = 0; id < COMPONENT_COUNT; ++id) {
+      if (!mask.test(id))
+        continue;
+      offset                       = align_pow2(offset, static_cast<USize>(s_layouts[id].align));
+      archetype->column_offset[id] = static_cast<U32>(offset);
+      offset += static_cast<USize>(s_layouts[id].size) * capacity;
+    }
+    if (offset <= CHUNK_SIZE)
+      break;
+  }
+  ASSERT(capacity > 0 && "Component row does not fit in an archetype chunk");
+  archetype->capacity = capacity;
+
+  m_archetypes.push(m_pool_arena, archetype);
+  return archetype;
+}
+
+template<typename ExtraComponents>
+typename ArchetypeEntityManager<ExtraComponents>::EntityLocation
+ArchetypeEntityManager<ExtraComponents>::allocate_row(archetype_type* archetype, Entity e) {
+  if (archetype->chunks.count == 0 ||
+      chunk_header(archetype->chunks[archetype->chunks.count - 1])->count == archetype->capacity) {
+    U8* chunk = nullptr;
+    if (m_free_chunks.count > 0)
+      chunk = m_free_chunks[--m_free_chunks.count];
+    else
+      chunk = m_pool_arena->push_array_no_zero_aligned<U8>(CHUNK_SIZE, CHUNK_HEADER_SIZE);
+    chunk_header(chunk)->count = 0;
+    archetype->chunks.push(m_pool_arena, chunk);
+  }
+
+  const U32 chunk_index = static_cast<U32>(archetype->chunks.count - 1);
+  U8*       chunk       = archetype->chunks[chunk_index];
+  const U32 row         = chunk_header(chunk)->count++;
+  chunk_entities(chunk)[row] = e;
+  archetype->entity_count++;
+
+  return EntityLocation{archetype, chunk_index, row};
+}
+
+template<typename ExtraComponents>
+void ArchetypeEntityManager<ExtraComponents>::remove_row(const EntityLocation& location,
+                                                         bool                  destroy_components) {
+  archetype_type& archetype = *location.archetype;
+  U8*             chunk     = archetype.chunks[location.chunk];
+
+  if (destroy_components) {
+    for (USize id = 0; id < COMPONENT_COUNT; ++id) {
+      if (archetype.column_offset[id] != archetype_type::NO_COLUMN)
+        s_layouts[id].destroy_fn(column_ptr(archetype, chunk, id, location.row));
+    }
+  }
+
+  const U32 last_chunk_index = static_cast<U32>(archetype.chunks.count - 1);
+  U8*       last_chunk       = archetype.chunks[last_chunk_index];
+  const U32 last_row         = chunk_header(last_chunk)->count - 1;
+
+  if (location.chunk != last_chunk_index || location.row != last_row) {
+    for (USize id = 0; id < COMPONENT_COUNT; ++id) {
+      if (archetype.column_offset[id] != archetype_type::NO_COLUMN)
+        s_layouts[id].relocate_fn(column_ptr(archetype, chunk, id, location.row),
+                                  column_ptr(archetype, last_chunk, id, last_row));
+    }
+    Entity moved                        = chunk_entities(last_chunk)[last_row];
+    chunk_entities(chunk)[location.row] = moved;
+    m_locations[moved.index]            = location;
+  }
+
+  archetype.entity_count--;
+  if (--chunk_header(last_chunk)->count == 0) {
+    m_free_chunks.push(m_pool_arena, last_chunk);
+    archetype.chunks.count--;
+  }
+}
+
+template<typename ExtraComponents>
+void ArchetypeEntityManager<ExtraComponents>::move_entity(Entity e, archetype_type* target) {
+  const EntityLocation from   = m_locations[e.index];
+  const EntityLocation to     = allocate_row(target, e);
+  U8*                  source = from.archetype->chunks[from.chunk];
+  U8*                  dest   = target->chunks[to.chunk];
+
+  for (USize id = 0; id < COMPONENT_COUNT; ++id) {
+    if (from.archetype->column_offset[id] == archetype_type::NO_COLUMN)
+      continue;
+    void* src = column_ptr(*from.archetype, source, id, from.row);
+    if (target->column_offset[id] != archetype_type::NO_COLUMN)
+      s_layouts[id].relocate_fn(column_ptr(*target, dest, id, to.row), src);
+    else
+      s_layouts[id].destroy_fn(src);
+  }
+
+  // The source row now only holds moved-from slots, fill it without destroying anything
+  remove_row(from, false);
+  m_locations[e.index] = to;
+}
+
+template<typename ExtraComponents>
+Entity ArchetypeEntityManager<ExtraComponents>::create() {
+  if (!m_empty_archetype)
+    m_empty_archetype = find_or_create_archetype(ComponentMask{});
+
+  // Index 0 is reserved as the null entity
+  if (m_generations.count == 0) {
+    m_generations.push(m_pool_arena, 0);
+    m_locations.push(m_pool_arena, EntityLocation{});
+  }
+
+  const U32 idx =
+      m_free_list.count == 0 ? static_cast<U32>(m_generations.count) : pop_free_list();
+  if (idx >= m_generations.count) {
+    m_generations.push(m_pool_arena, 0);
+    m_locations.push(m_pool_arena, EntityLocation{});
+  }
+
+  Entity e            = {idx, m_generations[idx]};
+  m_locations[e.index] = allocate_row(m_empty_archetype, e);
+  return e;
+}
+
+template<typename ExtraComponents>
+void ArchetypeEntityManager<ExtraComponents>::destroy(Entity e) {
+  if (!is_alive(e))
+    return;
+
+  remove_row(m_locations[e.index], true);
+  m_locations[e.index] = EntityLocation{};
+  m_generations[e.index]++;
+  m_free_list.push(m_pool_arena, e.index);
+}
+
+template<typename ExtraComponents>
+template<typename T, typename... Args>
+T* ArchetypeEntityManager<ExtraComponents>::add_component(Entity e, Args&&... args) {
+  static_assert(component_info<T>::is_registered,
+                "Error: Component type is not registered, register it");
+  constexpr USize type_id = component_info<T>::id();
+  assert(is_alive(e) && "Adding a component to a dead entity");
+
+  archetype_type* current = m_locations[e.index].archetype;
+  if (current->mask.test(type_id)) {
+    log::engine::warn("Overwriting already existing component: {}, id: {} ",
+                      component_info<T>::name,
+                      type_id);
+    T* existing = static_cast<T*>(column_ptr(*current,
+                                             current->chunks[m_locations[e.index].chunk],
+                                             type_id,
+                                             m_locations[e.index].row));
+    *existing   = T{std::forward<Args>(args)...};
+    return existing;
+  }
+
+  archetype_type* target = current->add_edge[type_id];
+  if (!target) {
+    ComponentMask mask = current->mask;
+    mask.set(type_id);
+    target                     = find_or_create_archetype(mask);
+    current->add_edge[type_id] = target;
+    target->remove_edge[type_id] = current;
+  }
+
+  move_entity(e, target);
+  const EntityLocation& location = m_locations[e.index];
+  void* slot = column_ptr(*target, target->chunks[location.chunk], type_id, location.row);
+  return new (slot) T{std::forward<Args>(args)...};
+}
+
+template<typename ExtraComponents>
+template<typename T>
+bool ArchetypeEntityManager<ExtraComponents>::try_remove_component(Entity e) {
+  static_assert(component_info<T>::is_registered,
+                "Error: Can't remove component type that isn't registered");
+  constexpr USize type_id = component_info<T>::id();
+  if (!has_component<T>(e))
+    return false;
+
+  archetype_type* current = m_locations[e.index].archetype;
+  archetype_type* target  = current->remove_edge[type_id];
+  if (!target) {
+    ComponentMask mask = current->mask;
+    mask.reset(type_id);
+    target                        = find_or_create_archetype(mask);
+    current->remove_edge[type_id] = target;
+    target->add_edge[type_id]     = current;
+  }
+
+  move_entity(e, target);
+  return true;
+}
+
+template<typename ExtraComponents>
+template<typename T>
+T* ArchetypeEntityManager<ExtraComponents>::try_get_component(Entity e) {
+  static_assert(component_info<T>::is_registered,
+                "Error: Component type is not registered, register it");
+  if (!has_component<T>(e))
+    return nullptr;
+  return &get_component<T>(e);
+}
+
+template<typename ExtraComponents>
+template<typename T>
+T& ArchetypeEntityManager<ExtraComponents>::get_component(Entity e) {
+  assert(has_component<T>(e) && "Entity doesnt have component");
+  const EntityLocation& location = m_locations[e.index];
+  return *static_cast<T*>(column_ptr(*location.archetype,
+                                     location.archetype->chunks[location.chunk],
+                                     component_info<T>::id(),
+                                     location.row));
+}
+
+template<typename ExtraComponents>
+template<typename T>
+const T& ArchetypeEntityManager<ExtraComponents>::get_component(Entity e) const {
+  assert(has_component<T>(e) && "Entity doesnt have component");
+  const EntityLocation& location = m_locations[e.index];
+  return *static_cast<const T*>(column_ptr(*location.archetype,
+                                           location.archetype->chunks[location.chunk],
+                                           component_info<T>::id(),
+                                           location.row));
+}
+
+template<typename ExtraComponents>
+template<typename T>
+bool ArchetypeEntityManager<ExtraComponents>::has_component(Entity e) const {
+  return is_alive(e) && m_locations[e.index].archetype->mask.test(component_info<T>::id());
+}
+
+template<typename ExtraComponents>
+bool ArchetypeEntityManager<ExtraComponents>::is_alive(Entity e) const {
+  return e.index != 0 && e.index < m_generations.count && m_generations[e.index] == e.generation;
+}
+
+template<typename ExtraComponents>
+int ArchetypeEntityManager<ExtraComponents>::get_alive_entity_count() const {
+  U64 alive = 0;
+  for (const archetype_type* archetype : m_archetypes)
+    alive += archetype->entity_count;
+  return static_cast<int>(alive);
+}
+
+template<typename ExtraComponents>
+U32 ArchetypeEntityManager<ExtraComponents>::pop_free_list() {
+  return m_free_list[--m_free_list.count];
+}
+
+template<typename ExtraComponents>
+void ArchetypeEntityManager<ExtraComponents>::clear() {
+  for (archetype_type* archetype : m_archetypes) {
+    for (U8* chunk : archetype->chunks) {
+      for (U32 row = 0; row < chunk_header(chunk)->count; ++row) {
+        for (USize id = 0; id < COMPONENT_COUNT; ++id) {
+          if (archetype->column_offset[id] != archetype_type::NO_COLUMN)
+            s_layouts[id].destroy_fn(column_ptr(*archetype, chunk, id, row));
+        }
+      }
+    }
+  }
+
+  m_generations.clear();
+  m_free_list.clear();
+  m_locations.clear();
+  m_archetypes.clear();
+  m_free_chunks.clear();
+  m_empty_archetype = nullptr;
+  if (m_pool_arena)
+    m_pool_arena->clear();
+}
+
+template<typename ExtraComponents>
+void ArchetypeEntityManager<ExtraComponents>::serialize(Serializer& s) const {
+  s.write(static_cast<U32>(m_generations.count));
+  for (U64 i = 0; i < m_generations.count; ++i)
+    s.write(m_generations[i]);
+
+  s.write(static_cast<U32>(m_free_list.count));
+  for (U64 i = 0; i < m_free_list.count; ++i)
+    s.write(m_free_list[i]);
+
+  s.write(static_cast<U32>(get_alive_entity_count()));
+  for (const archetype_type* archetype : m_archetypes) {
+    for (U8* chunk : archetype->chunks) {
+      for (U32 row = 0; row < chunk_header(chunk)->count; ++row) {
+        Entity e = chunk_entities(chunk)[row];
+        s.write(e.index);
+        s.write(e.generation);
+        for (USize word = 0; word < SERIALIZED_MASK_WORDS; ++word)
+          s.write(word < ComponentMask::WORD_COUNT ? archetype->mask.words[word] : U64{0});
+      }
+    }
+  }
+
+  // One block per registered component in the SparseEntitySet layout: entities, then payloads
+  U32 serializable_count = 0;
+  for (USize id = 0; id < COMPONENT_COUNT; ++id) {
+    if (sd::ComponentFactory::is_registered(static_cast<U32>(id)))
+      serializable_count++;
+  }
+  s.write(serializable_count);
+
+  for (USize id = 0; id < COMPONENT_COUNT; ++id) {
+    if (!sd::ComponentFactory::is_registered(static_cast<U32>(id)))
+      continue;
+    s.write(static_cast<U32>(id));
+
+    U32 count = 0;
+    for (const archetype_type* archetype : m_archetypes) {
+      if (archetype->mask.test(id))
+        count += static_cast<U32>(archetype->entity_count);
+    }
+    s.write(count);
+
+    for (const archetype_type* archetype : m_archetypes) {
+      if (!archetype->mask.test(id))
+        continue;
+      for (U8* chunk : archetype->chunks) {
+        for (U32 row = 0; row < chunk_header(chunk)->count; ++row) {
+          s.write(chunk_entities(chunk)[row].index);
+          s.write(chunk_entities(chunk)[row].generation);
+        }
+      }
+    }
+
+    dispatch_component(id, [&]<typename T>() {
+      if constexpr (SerializableComponent<T>) {
+        for (const archetype_type* archetype : m_archetypes) {
+          if (!archetype->mask.test(id))
+            continue;
+          for (U8* chunk : archetype->chunks) {
+            for (U32 row = 0; row < chunk_header(chunk)->count; ++row)
+              ComponentSerializer<T>::serialize(
+                  *static_cast<const T*>(column_ptr(*archetype, chunk, id, row)), s);
+          }
+        }
+      }
+    });
+  }
+}
+
+template<typename ExtraComponents>
+void ArchetypeEntityManager<ExtraComponents>::deserialize(Serializer& s) {
+  {
+    U32 count = s.read<U32>();
+    for (U32 i = 0; i < count; ++i) {
+      m_generations.push(m_pool_arena, s.read<U32>());
+      m_locations.push(m_pool_arena, EntityLocation{});
+    }
+  }
+
+  {
+    U32 count = s.read<U32>();
+    for (U32 i = 0; i < count; ++i)
+      m_free_list.push(m_pool_arena, s.read<U32>());
+  }
+
+  if (!m_empty_archetype)
+    m_empty_archetype = find_or_create_archetype(ComponentMask{});
+
+  // Rows are allocated in their final archetype up front, components start default constructed
+  // and the pool blocks below overwrite the serialized ones
+  U32 alive_count = s.read<U32>();
+  for (U32 i = 0; i < alive_count; ++i) {
+    Entity        e{s.read<U32>(), s.read<U32>()};
+    ComponentMask mask;
+    for (USize word = 0; word < SERIALIZED_MASK_WORDS; ++word) {
+      U64 bits = s.read<U64>();
+      if (word < ComponentMask::WORD_COUNT)
+        mask.words[word] = bits;
+    }
+
+    archetype_type* archetype = find_or_create_archetype(mask);
+    m_locations[e.index]      = allocate_row(archetype, e);
+    U8* chunk                 = archetype->chunks[m_locations[e.index].chunk];
+    for (USize id = 0; id < COMPONENT_COUNT; ++id) {
+      if (archetype->column_offset[id] != archetype_type::NO_COLUMN)
+        s_layouts[id].construct_fn(column_ptr(*archetype, chunk, id, m_locations[e.index].row));
+    }
+  }
+
+  U32 serializable_count = s.read<U32>();
+  for (U32 i = 0; i < serializable_count; ++i) {
+    U32 component_id = s.read<U32>();
+    U32 count        = s.read<U32>();
+
+    Entity* entities = m_pool_arena->push_array_no_zero<Entity>(count);
+    for (U32 j = 0; j < count; ++j) {
+      entities[j].index      = s.read<U32>();
+      entities[j].generation = s.read<U32>();
+    }
+
+    dispatch_component(component_id, [&]<typename T>() {
+      if constexpr (SerializableComponent<T>) {
+        for (U32 j = 0; j < count; ++j) {
+          T comp;
+          ComponentSerializer<T>::deserialize(comp, s);
+          if (has_component<T>(entities[j]))
+            get_component<T>(entities[j]) = std::move(comp);
+        }
+      }
+    });
+  }
+}
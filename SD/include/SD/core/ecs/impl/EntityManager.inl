@@ -1,17 +1,20 @@
 #pragma once
 
 template<typename ExtraComponents, typename... Components>
-ViewImpl<ExtraComponents, Components...>::ViewImpl(EntityManager<ExtraComponents>& manager) :
-  m_manager(manager) {
+ViewImpl<ExtraComponents, Components...>::ViewImpl(EntityManager<ExtraComponents>& manager,
+                                                   const Mask&                      exclude) :
+  m_manager(manager),
+  m_pools(manager.template get_component_pool<view_component_t<Components>>()...),
+  m_exclude(exclude), m_test_mask(required_count > 1 || !exclude.none()) {
   USize min_size = std::numeric_limits<USize>::max();
   (check_size<Components>(min_size), ...);
 }
 
 template<typename ExtraComponents, typename... Components>
-ViewImpl<ExtraComponents, Components...>::Iterator::Iterator(EntityManager<ExtraComponents>& em,
-                                                             const ArenaVec<Entity>* dense_entities,
+ViewImpl<ExtraComponents, Components...>::Iterator::Iterator(const ViewImpl*         v,
+                                                             const PagedVec<Entity>* dense_entities,
                                                              USize                   idx) :
-  manager(em), entities(dense_entities), index(idx) {
+  view(v), entities(dense_entities), index(idx) {
   if (entities && index < entities->count && !is_valid())
     next();
 }
@@ -24,11 +27,10 @@ ViewImpl<ExtraComponents, Components...>::Iterator::operator++() {
 }
 
 template<typename ExtraComponents, typename... Components>
-std::tuple<Entity, Components&...>
+ViewImpl<ExtraComponents, Components...>::Iterator::value_type
 ViewImpl<ExtraComponents, Components...>::Iterator::operator*() const {
   Entity current_entity = (*entities)[index];
-  return std::tuple_cat(std::make_tuple(current_entity),
-                        manager.template get_component_group<Components...>(current_entity));
+  return value_type(current_entity, view->template fetch<Components>(current_entity, index)...);
 }
 
 template<typename ExtraComponents, typename... Components>
@@ -44,8 +46,60 @@ template<typename ExtraComponents, typename... Components>
 bool ViewImpl<ExtraComponents, Components...>::Iterator::is_valid() const {
   if (!entities)
     return false;
-  Entity current_entity = (*entities)[index];
-  return (manager.template has_component<Components>(current_entity) && ...);
+  return view->matches((*entities)[index]);
+}
+
+template<typename ExtraComponents, typename... Components>
+bool ViewImpl<ExtraComponents, Components...>::matches(Entity e) const {
+  // Every entity in the only required pool trivially matches
+  if (!m_test_mask)
+    return true;
+
+  static constexpr Mask required = [] {
+    Mask mask;
+    auto require = [&]<typename Term>() {
+      if constexpr (!ViewTerm<Term>::optional)
+        mask.set(component_info<view_component_t<Term>>::id());
+    };
+    (require.template operator()<Components>(), ...);
+    return mask;
+  }();
+
+  // Entities in a dense pool are always alive, so the mask lookup can skip generation checks
+  if (!m_manager.m_records[e.index].mask.matches(required, m_exclude))
+    return false;
+
+  if constexpr (changed_count > 1) {
+    // Only the shortest changed list drives iteration, the other Changed terms are tested here.
+    // The mask already proved the entity is in each of their pools
+    auto changed = [&]<typename Term>() {
+      if constexpr (ViewTerm<Term>::changed) {
+        auto* pool = std::get<SparseEntitySet<view_component_t<Term>>*>(m_pools);
+        return &pool->get_changed_entities() == m_smallest_pool ||
+               pool->dense_changed[pool->sparse_at(e)] != SPARSE_NONE;
+      } else {
+        return true;
+      }
+    };
+    return (changed.template operator()<Components>() && ...);
+  }
+  return true;
+}
+
+template<typename ExtraComponents, typename... Components>
+template<typename Fn>
+void ViewImpl<ExtraComponents, Components...>::par_each(JobSystem& jobs, Fn&& fn, USize grain) {
+  if (!m_smallest_pool)
+    return;
+
+  const PagedVec<Entity>& entities = *m_smallest_pool;
+  jobs.parallel_for(entities.count, grain, [&](USize begin, USize end) {
+    for (USize i = begin; i < end; ++i) {
+      Entity e = entities[i];
+      if (matches(e))
+        fn(e, fetch<Components>(e, i)...);
+    }
+  });
 }
 
 template<typename ExtraComponents, typename... Components>
@@ -56,44 +110,392 @@ ViewImpl<ExtraComponents, Components...>::begin() {
         "View has no valid component pools - scene may be empty or missing components");
     return end();
   }
-  return Iterator(m_manager, m_smallest_pool, 0);
+  return Iterator(this, m_smallest_pool, 0);
 }
 
 template<typename ExtraComponents, typename... Components>
 typename ViewImpl<ExtraComponents, Components...>::Iterator
 ViewImpl<ExtraComponents, Components...>::end() {
   if (!m_smallest_pool)
-    return Iterator(m_manager, nullptr, 0);
-  return Iterator(m_manager, m_smallest_pool, m_smallest_pool->count);
+    return Iterator(this, nullptr, 0);
+  return Iterator(this, m_smallest_pool, m_smallest_pool->count);
 }
 
 template<typename ExtraComponents, typename... Components>
 template<typename Component>
 void ViewImpl<ExtraComponents, Components...>::check_size(USize& minSize) {
-  if (!m_manager.template has_component_pool<Component>()) {
+  // Optional terms never drive iteration, and a missing pool only means none has it. Tags have
+  // no pool, matches() checks their bit
+  if constexpr (ViewTerm<Component>::optional || ViewTerm<Component>::tag)
+    return;
+
+  auto* pool = std::get<SparseEntitySet<view_component_t<Component>>*>(m_pools);
+  if (!pool) {
     minSize         = 0;
     m_smallest_pool = nullptr;
     return;
   }
 
-  auto* pool = m_manager.template get_component_pool<Component>();
-  if (pool->size() < minSize) {
-    minSize         = pool->size();
-    m_smallest_pool = &pool->get_dense_entities();
+  // With a Changed filter only changed lists drive iteration, every listed entity is in its pool
+  if constexpr (ViewTerm<Component>::changed) {
+    assert(pool->track_changes && "Changed<T> filter on a pool without change tracking");
+    if (pool->changed_entities.count < minSize) {
+      minSize         = pool->changed_entities.count;
+      m_smallest_pool = &pool->get_changed_entities();
+    }
+  } else if constexpr (!has_changed_filter) {
+    if (pool->size() < minSize) {
+      minSize         = pool->size();
+      m_smallest_pool = &pool->get_dense_entities();
+    }
+  }
+}
+
+template<typename ExtraComponents, typename... Components>
+template<typename Component>
+view_result_t<Component>
+ViewImpl<ExtraComponents, Components...>::fetch(Entity e, USize dense_idx) const {
+  using T    = view_component_t<Component>;
+  auto* pool = std::get<SparseEntitySet<T>*>(m_pools);
+  if constexpr (ViewTerm<Component>::tag && ViewTerm<Component>::optional) {
+    const bool has = m_manager.m_records[e.index].mask.test(component_info<T>::id());
+    return has ? &g_tag_instance<T> : nullptr;
+  } else if constexpr (ViewTerm<Component>::tag) {
+    return g_tag_instance<T>;
+  } else if constexpr (ViewTerm<Component>::optional) {
+    return pool ? pool->get(e) : view_result_t<Component>{};
+  } else {
+    // The pool driving iteration is indexed directly, the rest take one sparse lookup
+    if (&pool->get_dense_entities() == m_smallest_pool)
+      return pool->dense_data[dense_idx];
+    return pool->get_unchecked(e);
   }
 }
 
+template<typename ExtraComponents, typename... Owned>
+std::tuple<Entity, component_ref_t<Owned>...>
+GroupImpl<ExtraComponents, Owned...>::Iterator::operator*() const {
+  return std::tuple<Entity, component_ref_t<Owned>...>(
+      std::get<0>(group->m_pools)->dense_entities[index],
+      std::get<SparseEntitySet<Owned>*>(group->m_pools)->dense_data[index]...);
+}
+
+template<typename ExtraComponents, typename... Owned>
+bool GroupImpl<ExtraComponents, Owned...>::contains(Entity e) const {
+  // dense_index() is max() for absent entities, so this is also false for them
+  return std::get<0>(m_pools)->dense_index(e) < m_size;
+}
+
+template<typename ExtraComponents, typename... Owned>
+template<typename Fn>
+void GroupImpl<ExtraComponents, Owned...>::each(Fn&& fn) {
+  const PagedVec<Entity>& entities = std::get<0>(m_pools)->dense_entities;
+  std::tuple<typename ComponentStorage<Owned>::container*...> data{
+      &std::get<SparseEntitySet<Owned>*>(m_pools)->dense_data...};
+  for (USize i = 0; i < m_size; ++i)
+    fn(entities[i], (*std::get<typename ComponentStorage<Owned>::container*>(data))[i]...);
+}
+
+template<typename ExtraComponents, typename... Owned>
+template<typename Component, typename Compare>
+void GroupImpl<ExtraComponents, Owned...>::sort(Compare&& less) {
+  auto* lead = std::get<SparseEntitySet<Component>*>(m_pools);
+  // Groups sorted every frame are usually still in order, skip the other pools then
+  if (!lead->sort(less, 0, m_size))
+    return;
+  // Every owned pool holds the same entities in [0, m_size), so each entity is found at or past i
+  auto follow = [&]<typename P>(SparseEntitySet<P>* pool) {
+    if constexpr (!std::is_same_v<P, Component>) {
+      for (USize i = 0; i < m_size; ++i)
+        pool->swap_dense(pool->dense_index(lead->dense_entities[i]), i);
+    }
+  };
+  (follow(std::get<SparseEntitySet<Owned>*>(m_pools)), ...);
+}
+
+template<typename ExtraComponents, typename... Owned>
+template<typename Component, std::meta::info Member>
+auto GroupImpl<ExtraComponents, Owned...>::column() const {
+  static_assert(SoAComponent<Component>, "column() needs an SoA component");
+  auto* pool = std::get<SparseEntitySet<Component>*>(m_pools);
+  return pool->dense_data.template column<Member>().first(m_size);
+}
+
+template<typename ExtraComponents, typename... Owned>
+constexpr auto GroupImpl<ExtraComponents, Owned...>::required_mask() {
+  using Mask = typename manager_type::ComponentMask;
+  return Mask::from_ids({component_info<Owned>::id()...});
+}
+
+template<typename ExtraComponents, typename... Owned>
+void GroupImpl<ExtraComponents, Owned...>::on_add(void* group, const void* mask, Entity e) {
+  using Mask                     = typename manager_type::ComponentMask;
+  static constexpr Mask required = required_mask();
+
+  auto* self = static_cast<GroupImpl*>(group);
+  if (static_cast<const Mask*>(mask)->contains(required) && !self->contains(e))
+    self->pack(e);
+}
+
+template<typename ExtraComponents, typename... Owned>
+void GroupImpl<ExtraComponents, Owned...>::on_remove(void* group, Entity e) {
+  auto* self = static_cast<GroupImpl*>(group);
+  if (self->contains(e))
+    self->unpack(e);
+}
+
+template<typename ExtraComponents, typename... Owned>
+void* GroupImpl<ExtraComponents, Owned...>::relocate(const void*              group,
+                                                     Arena*                   arena,
+                                                     const ComponentPoolNode* nodes) {
+  auto* moved = new (arena_push_no_zero<GroupImpl>(arena)) GroupImpl(
+      static_cast<SparseEntitySet<Owned>*>(nodes[component_info<Owned>::id()].pool)...);
+  moved->m_size = static_cast<const GroupImpl*>(group)->m_size;
+  return moved;
+}
+
+template<typename ExtraComponents, typename... Owned>
+void GroupImpl<ExtraComponents, Owned...>::pack(Entity e) {
+  std::apply([&](auto*... pools) { (pools->swap_dense(pools->dense_index(e), m_size), ...); },
+             m_pools);
+  ++m_size;
+}
+
+template<typename ExtraComponents, typename... Owned>
+void GroupImpl<ExtraComponents, Owned...>::unpack(Entity e) {
+  // Move to the last slot of the prefix and shrink it, the pools' own swap-remove then only ever
+  // touches entries past the group
+  --m_size;
+  std::apply([&](auto*... pools) { (pools->swap_dense(pools->dense_index(e), m_size), ...); },
+             m_pools);
+}
+
 template<typename ExtraComponents>
 template<typename T, typename... Args>
-T* EntityManager<ExtraComponents>::add_component(Entity e, Args&&... args) {
+component_ptr_t<T> EntityManager<ExtraComponents>::add_component(Entity e, Args&&... args) {
   static_assert(component_info<T>::is_registered,
                 "Error: Component type is not registered, register it");
   const USize type_id = component_info<T>::id();
 
+  assert(is_alive(e) && "Adding a component to a dead entity");
+
+  if constexpr (TagComponent<T>) {
+    ComponentMask& mask = m_records[e.index].mask;
+    if (!mask.test(type_id)) {
+      mask.set(type_id);
+      ComponentPoolNode::notify(ensure_node(type_id).on_construct, e);
+    }
+    return &g_tag_instance<T>;
+  } else {
+    auto*          pool      = ensure_pool<T>();
+    auto&          node      = m_component_pools[type_id];
+    ComponentMask& mask      = m_records[e.index].mask;
+    const bool     overwrite = mask.test(type_id);
+    if (overwrite)
+      log::engine::warn("Overwriting already existing component: {}, id: {} ",
+                        component_info<T>::name,
+                        type_id);
+
+    mask.set(type_id);
+    pool->add(e, std::forward<Args>(args)...);
+    if (node.group)
+      node.group_on_add_fn(node.group, &mask, e);
+    ComponentPoolNode::notify(overwrite ? node.on_update : node.on_construct, e);
+    return pool->get(e);
+  }
+}
+
+template<typename ExtraComponents>
+template<typename T>
+void EntityManager<ExtraComponents>::add_components(std::span<const Entity> entities,
+                                                    std::span<const T>      values) {
+  static_assert(component_info<T>::is_registered,
+                "Error: Component type is not registered, register it");
+  assert(entities.size() == values.size() && "One value per entity");
+  if constexpr (TagComponent<T>) {
+    add_tags<T>(entities);
+  } else {
+    const USize type_id = component_info<T>::id();
+
+    auto* pool = ensure_pool<T>();
+    for (Entity e : entities) {
+      assert(is_alive(e) && "Adding a component to a dead entity");
+      m_records[e.index].mask.set(type_id);
+    }
+    pool->add_many(entities, values);
+
+    auto& node = m_component_pools[type_id];
+    if (node.group) {
+      for (Entity e : entities)
+        node.group_on_add_fn(node.group, &m_records[e.index].mask, e);
+    }
+    for (Entity e : entities)
+      ComponentPoolNode::notify(node.on_construct, e);
+  }
+}
+
+template<typename ExtraComponents>
+template<typename T, typename Fn>
+  requires std::invocable<Fn&, USize>
+void EntityManager<ExtraComponents>::add_components(std::span<const Entity> entities, Fn&& make) {
+  static_assert(component_info<T>::is_registered,
+                "Error: Component type is not registered, register it");
+  if constexpr (TagComponent<T>) {
+    add_tags<T>(entities);
+  } else {
+    const USize type_id = component_info<T>::id();
+
+    auto* pool = ensure_pool<T>();
+    pool->reserve(pool->size() + entities.size());
+    for (USize i = 0; i < entities.size(); ++i) {
+      assert(is_alive(entities[i]) && "Adding a component to a dead entity");
+      m_records[entities[i].index].mask.set(type_id);
+      pool->add(entities[i], make(i));
+    }
+
+    auto& node = m_component_pools[type_id];
+    if (node.group) {
+      for (Entity e : entities)
+        node.group_on_add_fn(node.group, &m_records[e.index].mask, e);
+    }
+    for (Entity e : entities)
+      ComponentPoolNode::notify(node.on_construct, e);
+  }
+}
+
+template<typename ExtraComponents>
+template<TagComponent T>
+void EntityManager<ExtraComponents>::add_tags(std::span<const Entity> entities) {
+  const USize        type_id = component_info<T>::id();
+  ComponentPoolNode& node    = ensure_node(type_id);
+  for (Entity e : entities) {
+    assert(is_alive(e) && "Adding a component to a dead entity");
+    ComponentMask& mask = m_records[e.index].mask;
+    if (mask.test(type_id))
+      continue;
+    mask.set(type_id);
+    ComponentPoolNode::notify(node.on_construct, e);
+  }
+}
+
+template<typename ExtraComponents>
+Prefab EntityManager<ExtraComponents>::capture_prefab(Entity e, Arena* arena) const {
+  using CaptureFn = void (EntityManager::*)(Entity, void*) const;
+
+  // Bytes a component takes in the blob, 0 for tags. Components that cannot be copied bytewise
+  // are marked with g_type_max
+  static constexpr auto sizes = []<typename... Ts>(ComponentGroup<Ts...>) {
+    return std::array<U32, sizeof...(Ts)>{
+        TagComponent<Ts> ? 0u
+        : std::is_trivially_copyable_v<Ts> ? static_cast<U32>(sizeof(Ts))
+                                           : g_type_max<U32>...};
+  }(all_components{});
+  static constexpr auto aligns = []<typename... Ts>(ComponentGroup<Ts...>) {
+    return std::array<U32, sizeof...(Ts)>{static_cast<U32>(alignof(Ts))...};
+  }(all_components{});
+  static constexpr auto captured = []<typename... Ts>(ComponentGroup<Ts...>) {
+    return std::array<bool, sizeof...(Ts)>{k_prefab_component<Ts>...};
+  }(all_components{});
+  static constexpr auto capture_fns = []<typename... Ts>(ComponentGroup<Ts...>) {
+    return std::array<CaptureFn, sizeof...(Ts)>{&EntityManager::capture_component<Ts>...};
+  }(all_components{});
+
+  assert(is_alive(e) && "Capturing a dead entity");
+  Prefab prefab;
+  prefab.arena = arena;
+
+  const ComponentMask& mask = m_records[e.index].mask;
+  for (U32 id = 0; id < COMPONENT_COUNT; ++id) {
+    if (!mask.test(id) || !captured[id])
+      continue;
+    if (sizes[id] == g_type_max<U32>) {
+      log::engine::warn("Component '{}' is not trivially copyable, it is left out of the prefab",
+                        COMPONENT_NAMES[id]);
+      continue;
+    }
+    assert(aligns[id] <= Prefab::DATA_ALIGN && "Component is aligned past the prefab blob");
+    prefab.data_size = (prefab.data_size + aligns[id] - 1) & ~(aligns[id] - 1);
+    prefab.components.push(arena, PrefabComponent{id, sizes[id], prefab.data_size});
+    prefab.data_size += sizes[id];
+  }
+
+  prefab.data = static_cast<U8*>(arena->push(prefab.data_size, Prefab::DATA_ALIGN, true));
+  for (const PrefabComponent& component : prefab.components)
+    (this->*capture_fns[component.type_id])(e, prefab.data + component.offset);
+  return prefab;
+}
+
+template<typename ExtraComponents>
+template<typename T>
+void EntityManager<ExtraComponents>::capture_component(Entity e, void* dst) const {
+  if constexpr (!TagComponent<T> && std::is_trivially_copyable_v<T>) {
+    const auto* pool =
+        static_cast<const SparseEntitySet<T>*>(m_component_pools[component_info<T>::id()].pool);
+    const T value = pool->load(pool->dense_index(e));
+    std::memcpy(dst, &value, sizeof(T));
+  }
+}
+
+template<typename ExtraComponents>
+void EntityManager<ExtraComponents>::instantiate(const Prefab& prefab, std::span<Entity> out) {
+  using InstantiateFn =
+      void (EntityManager::*)(std::span<const Entity>, const PrefabComponent&, const U8*);
+
+  static constexpr auto instantiate_fns = []<typename... Ts>(ComponentGroup<Ts...>) {
+    return std::array<InstantiateFn, sizeof...(Ts)>{&EntityManager::instantiate_component<Ts>...};
+  }(all_components{});
+
+  create_many(out);
+  for (const PrefabComponent& component : prefab.components) {
+    assert(component.type_id < COMPONENT_COUNT && "Prefab was captured from another schema");
+    (this->*instantiate_fns[component.type_id])(out, component, prefab.data);
+  }
+}
+
+template<typename ExtraComponents>
+template<typename T>
+void EntityManager<ExtraComponents>::instantiate_component(std::span<const Entity> entities,
+                                                           const PrefabComponent&  component,
+                                                           const U8*               data) {
+  if constexpr (TagComponent<T>) {
+    add_tags<T>(entities);
+  } else if constexpr (!std::is_trivially_copyable_v<T>) {
+    assert(false && "Prefabs only hold trivially copyable components");
+  } else {
+    assert(component.size == sizeof(T) && "Prefab component does not match the schema");
+    const USize type_id = component_info<T>::id();
+    // The blob was filled by memcpy, which began the lifetime of the value at this offset
+    const T& value = *std::launder(reinterpret_cast<const T*>(data + component.offset));
+
+    auto* pool = ensure_pool<T>();
+    for (Entity e : entities)
+      m_records[e.index].mask.set(type_id);
+    pool->add_copies(entities, value);
+
+    auto& node = m_component_pools[type_id];
+    if (node.group) {
+      for (Entity e : entities)
+        node.group_on_add_fn(node.group, &m_records[e.index].mask, e);
+    }
+    for (Entity e : entities)
+      ComponentPoolNode::notify(node.on_construct, e);
+  }
+}
+
+template<typename ExtraComponents>
+ComponentPoolNode& EntityManager<ExtraComponents>::ensure_node(USize type_id) {
   while (m_component_pools.count <= type_id)
     m_component_pools.push(m_pool_arena, ComponentPoolNode{});
+  return m_component_pools[type_id];
+}
 
-  auto& node = m_component_pools[type_id];
+template<typename ExtraComponents>
+template<typename T>
+SparseEntitySet<T>* EntityManager<ExtraComponents>::ensure_pool() {
+  static_assert(!TagComponent<T>, "Tags are stored in the entity mask, they have no pool");
+  const USize type_id = component_info<T>::id();
+
+  auto& node = ensure_node(type_id);
   if (!node.pool) {
     auto* pool     = m_pool_arena->push_array<SparseEntitySet<T>>(1);
     pool->arena    = m_pool_arena;
@@ -107,52 +509,336 @@ T* EntityManager<ExtraComponents>::add_component(Entity e, Args&&... args) {
     node.deserialize_fn = [](void* p, Serializer& s) {
       static_cast<SparseEntitySet<T>*>(p)->deserialize(s);
     };
+    node.clear_changed_fn = [](void* p) { static_cast<SparseEntitySet<T>*>(p)->clear_changed(); };
+    node.stats_fn         = [](const void* p) {
+      return static_cast<const SparseEntitySet<T>*>(p)->stats();
+    };
+    node.compact_fn = [](void* p, Arena* fresh) -> void* {
+      auto* compacted  = fresh->push_array<SparseEntitySet<T>>(1);
+      compacted->arena = fresh;
+      compacted->compact_from(*static_cast<SparseEntitySet<T>*>(p));
+      return compacted;
+    };
   }
+  return static_cast<SparseEntitySet<T>*>(node.pool);
+}
 
-  auto* pool = static_cast<SparseEntitySet<T>*>(node.pool);
-  if (m_entity_masks.get(e)->test(type_id))
-    log::engine::warn("Overwriting already existing component: {}, id: {} ",
-                      component_info<T>::name,
-                      type_id);
+template<typename ExtraComponents>
+template<typename... Owned>
+GroupImpl<ExtraComponents, Owned...>& EntityManager<ExtraComponents>::group() {
+  using Group = GroupImpl<ExtraComponents, Owned...>;
+
+  using Lead  = std::tuple_element_t<0, std::tuple<Owned...>>;
+  static_assert((!TagComponent<Owned> && ...), "Tags have no pool for a group to own");
+
+  (ensure_pool<Owned>(), ...);
+
+  auto& lead_node = m_component_pools[component_info<Lead>::id()];
+  if (lead_node.group) {
+    assert(lead_node.group_on_add_fn == &Group::on_add &&
+           "Component is already owned by a different group");
+    return *static_cast<Group*>(lead_node.group);
+  }
+
+  auto* group = new (arena_push_no_zero<Group>(m_pool_arena)) Group(ensure_pool<Owned>()...);
+  for (USize type_id : {component_info<Owned>::id()...}) {
+    auto& node = m_component_pools[type_id];
+    assert(!node.group && "Component is already owned by a different group");
+    node.group              = group;
+    node.group_on_add_fn    = &Group::on_add;
+    node.group_on_remove_fn = &Group::on_remove;
+    node.group_relocate_fn  = &Group::relocate;
+  }
 
-  m_entity_masks.get(e)->set(type_id);
-  pool->add(e, std::forward<Args>(args)...);
-  return pool->get(e);
+  // Pack entities that already have every owned component. Swaps only move entries into slots
+  // below the cursor, which were already visited
+  static constexpr ComponentMask required = Group::required_mask();
+
+  auto* lead = std::get<0>(group->m_pools);
+  for (USize i = 0; i < lead->size(); ++i) {
+    Entity e = lead->dense_entities[i];
+    if (m_records[e.index].mask.contains(required))
+      group->pack(e);
+  }
+  return *group;
 }
 
 template<typename ExtraComponents>
 template<typename T>
-T* EntityManager<ExtraComponents>::try_get_component(Entity e) {
+component_ptr_t<T> EntityManager<ExtraComponents>::try_get_component(Entity e) {
   static_assert(component_info<T>::is_registered,
                 "Error: Component type is not registered, register it");
 
-  USize type_id = component_info<T>::id();
-  if (type_id >= m_component_pools.count || !m_component_pools[type_id].pool ||
-      !m_entity_masks.get(e)->test(type_id))
-    return nullptr;
-
-  auto* pool = static_cast<SparseEntitySet<T>*>(m_component_pools[type_id].pool);
-  return pool->get(e);
+  if (!has_component<T>(e))
+    return component_ptr_t<T>{};
+  if constexpr (TagComponent<T>) {
+    return &g_tag_instance<T>;
+  } else {
+    auto* pool = static_cast<SparseEntitySet<T>*>(m_component_pools[component_info<T>::id()].pool);
+    return pool->get(e);
+  }
 }
 
 template<typename ExtraComponents>
 template<typename T>
-T& EntityManager<ExtraComponents>::get_component(Entity e) {
+component_ref_t<T> EntityManager<ExtraComponents>::get_component(Entity e) {
   USize typeId = component_info<T>::id();
   assert(has_component<T>(e) && "Entity doesnt have component");
+  if constexpr (TagComponent<T>) {
+    return g_tag_instance<T>;
+  } else {
+    auto* pool = static_cast<SparseEntitySet<T>*>(m_component_pools[typeId].pool);
+    return pool->get_unchecked(e);
+  }
+}
+
+template<typename ExtraComponents>
+template<typename T, typename Fn>
+void EntityManager<ExtraComponents>::patch(Entity e, Fn&& fn) {
+  static_assert(!TagComponent<T>, "Tags have no data to change");
+  assert(has_component<T>(e) && "Entity doesnt have component");
 
-  auto* pool = static_cast<SparseEntitySet<T>*>(m_component_pools[typeId].pool);
-  return *pool->get(e);
+  auto& node = m_component_pools[component_info<T>::id()];
+  auto* pool = static_cast<SparseEntitySet<T>*>(node.pool);
+  fn(pool->get_unchecked(e));
+  pool->mark_changed(pool->sparse_at(e));
+  ComponentPoolNode::notify(node.on_update, e);
 }
 
 template<typename ExtraComponents>
 template<typename T>
-const T& EntityManager<ExtraComponents>::get_component(Entity e) const {
-  USize type_id = component_info<T>::id();
+component_ref_t<T> EntityManager<ExtraComponents>::get_mut(Entity e) {
+  static_assert(!TagComponent<T>, "Tags have no data to change");
   assert(has_component<T>(e) && "Entity doesnt have component");
 
-  auto* pool = static_cast<const SparseEntitySet<T>*>(m_component_pools[type_id].pool);
-  return *pool->get(e);
+  auto* pool = static_cast<SparseEntitySet<T>*>(m_component_pools[component_info<T>::id()].pool);
+  pool->mark_changed(pool->sparse_at(e));
+  return pool->get_unchecked(e);
+}
+
+template<typename ExtraComponents>
+template<typename T, typename Compare>
+void EntityManager<ExtraComponents>::sort(Compare&& less) {
+  auto* pool = get_component_pool<T>();
+  if (!pool)
+    return;
+  assert(!m_component_pools[component_info<T>::id()].group &&
+         "Pool is owned by a group, sort the group instead");
+  pool->sort(less);
+}
+
+template<typename ExtraComponents>
+template<typename T, typename Other>
+void EntityManager<ExtraComponents>::sort_as() {
+  auto* pool  = get_component_pool<T>();
+  auto* other = get_component_pool<Other>();
+  if (!pool || !other)
+    return;
+  assert(!m_component_pools[component_info<T>::id()].group &&
+         "Pool is owned by a group, sort the group instead");
+  pool->sort_as(*other);
+}
+
+template<typename ExtraComponents>
+template<typename T>
+void EntityManager<ExtraComponents>::track_changes() {
+  ensure_pool<T>()->enable_change_tracking();
+}
+
+template<typename ExtraComponents>
+inline void EntityManager<ExtraComponents>::clear_changes() {
+  for (auto& node : m_component_pools) {
+    if (node.clear_changed_fn)
+      node.clear_changed_fn(node.pool);
+  }
+}
+
+template<typename ExtraComponents>
+template<typename Fn>
+void EntityManager<ExtraComponents>::for_each_pool_stats(Fn&& fn) const {
+  for (USize i = 0; i < m_component_pools.count; ++i) {
+    const ComponentPoolNode& node = m_component_pools[i];
+    if (node.pool && node.stats_fn)
+      fn(i, COMPONENT_NAMES[i], node.stats_fn(node.pool));
+  }
+}
+
+template<typename ExtraComponents>
+inline std::string EntityManager<ExtraComponents>::pool_stats_json() const {
+  std::string out;
+  auto        it = std::back_inserter(out);
+  fmt::format_to(it,
+                 R"({{"arena_position":{},"entity_slots":{},"alive":{},"pools":[)",
+                 arena_position(),
+                 m_records.count,
+                 m_alive_count);
+  bool first = true;
+  for_each_pool_stats([&](USize id, std::string_view name, const PoolStats& stats) {
+    fmt::format_to(it,
+                   R"({}{{"id":{},"name":"{}","dense_count":{},"dense_capacity":{},)"
+                   R"("dense_bytes":{},"sparse_pages":{},"occupied_pages":{},"sparse_bytes":{},)"
+                   R"("abandoned_bytes":{}}})",
+                   first ? "" : ",",
+                   id,
+                   name,
+                   stats.dense_count,
+                   stats.dense_capacity,
+                   stats.dense_bytes,
+                   stats.sparse_pages,
+                   stats.occupied_pages,
+                   stats.sparse_bytes,
+                   stats.abandoned_bytes);
+    first = false;
+  });
+  out += "]}";
+  return out;
+}
+
+template<typename ExtraComponents>
+inline U64 EntityManager<ExtraComponents>::live_bytes() const {
+  U64 bytes = m_records.count * sizeof(EntityRecord) + m_free_list.count * sizeof(U32);
+  for_each_pool_stats([&](USize, std::string_view, const PoolStats& stats) {
+    bytes += stats.live_bytes;
+  });
+  for (const RuntimeComponentPool* pool : m_runtime_pools)
+    bytes += pool ? pool->live_bytes() + sizeof(RuntimeComponentPool) : 0;
+  return bytes + m_runtime_pools.count * sizeof(RuntimeComponentPool*);
+}
+
+template<typename ExtraComponents>
+inline U64 EntityManager<ExtraComponents>::footprint_bytes() const {
+  U64 bytes = m_records.cap * sizeof(EntityRecord) + m_records.abandoned +
+              m_free_list.cap * sizeof(U32) + m_free_list.abandoned;
+  for_each_pool_stats([&](USize, std::string_view, const PoolStats& stats) {
+    bytes += stats.dense_bytes + stats.sparse_bytes + stats.abandoned_bytes;
+  });
+  for (const RuntimeComponentPool* pool : m_runtime_pools)
+    bytes += pool ? pool->footprint_bytes() + sizeof(RuntimeComponentPool) : 0;
+  return bytes + m_runtime_pools.cap * sizeof(RuntimeComponentPool*);
+}
+
+template<typename ExtraComponents>
+inline Arena* EntityManager<ExtraComponents>::compact(Arena* fresh) {
+  Arena* old   = m_pool_arena;
+  m_pool_arena = fresh;
+
+  // Dropped slots fold their generations into the floor, so stale handles to them stay stale once
+  // the index is handed out again
+  U64 kept = m_records.count;
+  while (kept > 1 && !m_records[kept - 1].alive) {
+    --kept;
+    m_generation_floor = max(m_generation_floor, m_records[kept].generation);
+  }
+
+  ArenaVec<EntityRecord> records;
+  records.reserve(fresh, kept);
+  for (U64 i = 0; i < kept; ++i)
+    records.push(fresh, m_records[i]);
+
+  U64 free_count = 0;
+  for (U32 idx : m_free_list)
+    free_count += idx < kept;
+  ArenaVec<U32> free_list;
+  free_list.reserve(fresh, free_count);
+  for (U32 idx : m_free_list) {
+    if (idx < kept)
+      free_list.push(fresh, idx);
+  }
+
+  auto copy_observers = [&](const ArenaVec<ComponentObserver>& observers) {
+    ArenaVec<ComponentObserver> copy;
+    copy.reserve(fresh, observers.count);
+    for (const ComponentObserver& observer : observers)
+      copy.push(fresh, observer);
+    return copy;
+  };
+
+  ArenaVec<ComponentPoolNode> nodes;
+  nodes.reserve(fresh, m_component_pools.count);
+  for (ComponentPoolNode& node : m_component_pools) {
+    ComponentPoolNode moved = node;
+    moved.on_construct      = copy_observers(node.on_construct);
+    moved.on_update         = copy_observers(node.on_update);
+    moved.on_destroy        = copy_observers(node.on_destroy);
+    if (node.pool) {
+      assert(node.compact_fn && "Pool was not created by ensure_pool and cannot be moved");
+      moved.pool = node.compact_fn(node.pool, fresh);
+    }
+    nodes.push(fresh, moved);
+  }
+
+  // Owned pools share one group, relocate it once and point all of them at the copy
+  for (USize i = 0; i < nodes.count; ++i) {
+    void* group = m_component_pools[i].group;
+    if (!group || nodes[i].group != group)
+      continue;
+    void* relocated = nodes[i].group_relocate_fn(group, fresh, nodes.data);
+    for (USize j = i; j < nodes.count; ++j) {
+      if (nodes[j].group == group)
+        nodes[j].group = relocated;
+    }
+  }
+
+  ArenaVec<RuntimeComponentPool*> runtime_pools;
+  runtime_pools.reserve(fresh, m_runtime_pools.count);
+  for (RuntimeComponentPool* pool : m_runtime_pools) {
+    RuntimeComponentPool* moved = nullptr;
+    if (pool) {
+      moved        = arena_push<RuntimeComponentPool>(fresh);
+      moved->arena = fresh;
+      moved->compact_from(*pool);
+    }
+    runtime_pools.push(fresh, moved);
+  }
+
+  m_records         = records;
+  m_free_list       = free_list;
+  m_component_pools = nodes;
+  m_runtime_pools   = runtime_pools;
+  return old;
+}
+
+template<typename ExtraComponents>
+template<typename T>
+void EntityManager<ExtraComponents>::observe(ComponentEvent event, ComponentObserver observer) {
+  static_assert(component_info<T>::is_registered,
+                "Error: Component type is not registered, register it");
+  auto& node = ensure_node(component_info<T>::id());
+  if constexpr (!TagComponent<T>)
+    ensure_pool<T>();
+  node.observers(event).push(m_pool_arena, observer);
+}
+
+template<typename ExtraComponents>
+template<typename T>
+void EntityManager<ExtraComponents>::unobserve(ComponentEvent event, ComponentObserver observer) {
+  static_assert(component_info<T>::is_registered,
+                "Error: Component type is not registered, register it");
+  const USize type_id = component_info<T>::id();
+  if (type_id >= m_component_pools.count)
+    return;
+
+  // Keeps the order of the remaining observers, they run in registration order
+  ArenaVec<ComponentObserver>& observers = m_component_pools[type_id].observers(event);
+  U64                          kept      = 0;
+  for (const ComponentObserver& registered : observers) {
+    if (registered.fn != observer.fn || registered.user != observer.user)
+      observers[kept++] = registered;
+  }
+  observers.count = kept;
+}
+
+template<typename ExtraComponents>
+template<typename T>
+component_cref_t<T> EntityManager<ExtraComponents>::get_component(Entity e) const {
+  USize type_id = component_info<T>::id();
+  assert(has_component<T>(e) && "Entity doesnt have component");
+  if constexpr (TagComponent<T>) {
+    return g_tag_instance<T>;
+  } else {
+    auto* pool = static_cast<const SparseEntitySet<T>*>(m_component_pools[type_id].pool);
+    return pool->get_unchecked(e);
+  }
 }
 
 template<typename ExtraComponents>
@@ -162,53 +848,63 @@ bool EntityManager<ExtraComponents>::try_remove_component(Entity e) {
                 "Error: Can't remove component type that isn't registered");
 
   USize type_id = component_info<T>::id();
-  if (type_id >= m_component_pools.count || !m_component_pools[type_id].pool ||
-      !m_entity_masks.get(e)->test(type_id))
+  if (!has_component<T>(e))
     return false;
 
-  auto* pool = static_cast<SparseEntitySet<T>*>(m_component_pools[type_id].pool);
-  pool->remove(e);
-  m_entity_masks.get(e)->reset(type_id);
+  auto& node = m_component_pools[type_id];
+  ComponentPoolNode::notify(node.on_destroy, e);
+  if constexpr (!TagComponent<T>) {
+    if (node.group)
+      node.group_on_remove_fn(node.group, e);
+    static_cast<SparseEntitySet<T>*>(node.pool)->remove(e);
+  }
+  m_records[e.index].mask.reset(type_id);
   return true;
 }
 
 template<typename ExtraComponents>
-template<typename... Args>
-auto EntityManager<ExtraComponents>::view() {
+template<typename... Args, typename... Excluded>
+auto EntityManager<ExtraComponents>::view(Exclude<Excluded...>) {
+  static constexpr ComponentMask excluded =
+      ComponentMask::from_ids({component_info<Excluded>::id()...});
+
   if constexpr (sizeof...(Args) == 1) {
     using T = std::tuple_element_t<0, std::tuple<Args...>>;
     if constexpr (UnpackGroup<T>::is_group) {
-      return typename UnpackGroup<T>::type(*this);
+      return typename UnpackGroup<T>::type(*this, excluded);
     } else {
-      return ViewImpl<ExtraComponents, T>(*this);
+      return ViewImpl<ExtraComponents, T>(*this, excluded);
     }
   } else {
-    return ViewImpl<ExtraComponents, Args...>(*this);
+    return ViewImpl<ExtraComponents, Args...>(*this, excluded);
   }
 }
 
+template<typename ExtraComponents>
+template<typename... Args>
+auto EntityManager<ExtraComponents>::view() {
+  return view<Args...>(exclude<>);
+}
+
 template<typename ExtraComponents>
 template<typename T>
 bool EntityManager<ExtraComponents>::has_component(Entity e) const {
-  if (e.index >= m_entity_masks.get_dense_entities().count)
-    return false;
-  if (!is_alive(e))
-    return false;
-  auto mask = m_entity_masks.get(e);
-  return mask && mask->test(component_info<T>::id());
+  // A set bit implies the pool exists, the add that set it created it. Tags only have the bit
+  return is_alive(e) && m_records[e.index].mask.test(component_info<T>::id());
 }
 
 template<typename ExtraComponents>
 template<typename... Components>
-std::tuple<Components&...> EntityManager<ExtraComponents>::get_component_group(Entity e) {
-  return std::forward_as_tuple(get_component<Components>(e)...);
+std::tuple<component_ref_t<Components>...>
+EntityManager<ExtraComponents>::get_component_group(Entity e) {
+  return std::tuple<component_ref_t<Components>...>(get_component<Components>(e)...);
 }
 
 template<typename ExtraComponents>
 template<typename... Components>
-std::tuple<const Components&...>
+std::tuple<component_cref_t<Components>...>
 EntityManager<ExtraComponents>::get_component_group(Entity e) const {
-  return std::forward_as_tuple(get_component<Components>(e)...);
+  return std::tuple<component_cref_t<Components>...>(get_component<Components>(e)...);
 }
 
 template<typename ExtraComponents>
@@ -216,7 +912,7 @@ template<typename T>
 SparseEntitySet<T>* EntityManager<ExtraComponents>::get_component_pool() {
   static_assert(component_info<T>::is_registered != false, "Unregistered Component");
   const USize type_id = component_info<T>::id();
-  if (type_id >= m_component_pools.count || !m_component_pools[type_id].pool)
+  if (TagComponent<T> || type_id >= m_component_pools.count || !m_component_pools[type_id].pool)
     return nullptr;
 
   return static_cast<SparseEntitySet<T>*>(m_component_pools[type_id].pool);
@@ -232,17 +928,51 @@ bool EntityManager<ExtraComponents>::has_component_pool() {
 
 template<typename ExtraComponents>
 inline Entity EntityManager<ExtraComponents>::create() {
+  // Index 0 is reserved as the null entity
+  if (m_records.count == 0)
+    m_records.push(m_pool_arena, EntityRecord{});
+
   const uint32_t idx =
-      m_free_list.count == 0 ? static_cast<U32>(m_generations.count) + 1 : pop_free_list();
+      m_free_list.count == 0 ? static_cast<U32>(m_records.count) : pop_free_list();
 
-  if (idx >= m_generations.count)
-    m_generations.push(m_pool_arena, 0);
+  if (idx >= m_records.count)
+    m_records.push(m_pool_arena,
+                   EntityRecord{.generation = m_generation_floor, .alive = 0, .mask = {}});
 
-  Entity e = {idx, m_generations[idx]};
+  EntityRecord& record = m_records[idx];
+  record.alive         = 1;
+  m_alive_count++;
+  return Entity{idx, record.generation};
+}
+
+template<typename ExtraComponents>
+inline void EntityManager<ExtraComponents>::create_many(std::span<Entity> out) {
+  // Index 0 is reserved as the null entity
+  if (m_records.count == 0)
+    m_records.push(m_pool_arena, EntityRecord{});
+
+  USize i = 0;
+  for (; i < out.size() && m_free_list.count > 0; ++i) {
+    const U32     idx    = pop_free_list();
+    EntityRecord& record = m_records[idx];
+    record.alive         = 1;
+    out[i]               = Entity{idx, record.generation};
+  }
 
-  m_entity_masks.arena = m_pool_arena;
-  m_entity_masks.add(e, ComponentMask{});
-  return e;
+  m_records.reserve(m_pool_arena, m_records.count + (out.size() - i));
+  for (; i < out.size(); ++i) {
+    out[i] = Entity{static_cast<U32>(m_records.count), m_generation_floor};
+    m_records.push(m_pool_arena,
+                   EntityRecord{.generation = m_generation_floor, .alive = 1, .mask = {}});
+  }
+  m_alive_count += out.size();
+}
+
+template<typename ExtraComponents>
+inline void EntityManager<ExtraComponents>::destroy_many(std::span<const Entity> entities) {
+  m_free_list.reserve(m_pool_arena, m_free_list.count + entities.size());
+  for (Entity e : entities)
+    destroy(e);
 }
 
 template<typename ExtraComponents>
@@ -250,22 +980,106 @@ inline void EntityManager<ExtraComponents>::destroy(const Entity e) {
   if (!is_alive(e))
     return;
 
-  ComponentMask* mask = m_entity_masks.get(e);
-  assert(mask);
-
+  EntityRecord& record = m_records[e.index];
   for (U64 i = 0; i < m_component_pools.count; ++i) {
     auto& node = m_component_pools[i];
-    if (node.pool && mask->test(i))
-      node.remove_fn(node.pool, e);
+    if (!record.mask.test(i))
+      continue;
+    ComponentPoolNode::notify(node.on_destroy, e);
+    if (!node.pool)
+      continue;
+    if (node.group)
+      node.group_on_remove_fn(node.group, e);
+    node.remove_fn(node.pool, e);
   }
-  mask->reset();
-  m_generations[e.index]++;
+  for (RuntimeComponentPool* pool : m_runtime_pools) {
+    if (pool)
+      pool->remove(e);
+  }
+  record.mask.reset();
+  record.generation++;
+  record.alive = 0;
+  m_alive_count--;
   m_free_list.push(m_pool_arena, e.index);
 }
 
+template<typename ExtraComponents>
+inline RuntimeComponentPool* EntityManager<ExtraComponents>::runtime_pool(U32 slot) {
+  if (m_runtime_revision != ComponentRegistry::m_revision)
+    rebind_runtime_components();
+  return slot < m_runtime_pools.count ? m_runtime_pools[slot] : nullptr;
+}
+
+template<typename ExtraComponents>
+inline RuntimeComponentPool* EntityManager<ExtraComponents>::ensure_runtime_pool(U32 slot) {
+  if (auto* pool = runtime_pool(slot))
+    return pool;
+
+  assert(slot < ComponentRegistry::count() && "Component slot was never registered");
+  while (m_runtime_pools.count <= slot)
+    m_runtime_pools.push(m_pool_arena, nullptr);
+  auto* pool            = arena_push<RuntimeComponentPool>(m_pool_arena);
+  pool->info            = ComponentRegistry::info(slot);
+  pool->arena           = m_pool_arena;
+  m_runtime_pools[slot] = pool;
+  return pool;
+}
+
+template<typename ExtraComponents>
+inline void* EntityManager<ExtraComponents>::add_runtime_component(Entity e, U32 slot,
+                                                                   void* value) {
+  assert(is_alive(e) && "Adding a component to a dead entity");
+  return ensure_runtime_pool(slot)->add(e, value);
+}
+
+template<typename ExtraComponents>
+inline void* EntityManager<ExtraComponents>::try_get_runtime_component(Entity e, U32 slot) {
+  auto* pool = runtime_pool(slot);
+  return pool ? pool->get(e) : nullptr;
+}
+
+template<typename ExtraComponents>
+inline bool EntityManager<ExtraComponents>::remove_runtime_component(Entity e, U32 slot) {
+  auto* pool = runtime_pool(slot);
+  return pool && pool->remove(e);
+}
+
+template<typename ExtraComponents>
+template<typename T>
+T* EntityManager<ExtraComponents>::add_runtime_component(Entity e, T value) {
+  static_assert(!component_info<T>::is_registered, "Compiled components use add_component");
+  return static_cast<T*>(add_runtime_component(e, runtime_component_slot<T>(), &value));
+}
+
+template<typename ExtraComponents>
+template<typename T>
+T* EntityManager<ExtraComponents>::try_get_runtime_component(Entity e) {
+  static_assert(!component_info<T>::is_registered, "Compiled components use try_get_component");
+  return static_cast<T*>(try_get_runtime_component(e, runtime_component_slot<T>()));
+}
+
+template<typename ExtraComponents>
+template<typename T>
+bool EntityManager<ExtraComponents>::remove_runtime_component(Entity e) {
+  static_assert(!component_info<T>::is_registered,
+                "Compiled components use try_remove_component");
+  return remove_runtime_component(e, runtime_component_slot<T>());
+}
+
+template<typename ExtraComponents>
+inline void EntityManager<ExtraComponents>::rebind_runtime_components() {
+  m_runtime_revision = ComponentRegistry::m_revision;
+  for (U64 slot = 0; slot < m_runtime_pools.count; ++slot) {
+    RuntimeComponentPool* pool = m_runtime_pools[slot];
+    if (pool && !pool->rebind(ComponentRegistry::info(static_cast<U32>(slot))))
+      m_runtime_pools[slot] = nullptr;
+  }
+}
+
 template<typename ExtraComponents>
 inline bool EntityManager<ExtraComponents>::is_alive(const Entity e) const {
-  return e.index < m_generations.count && m_generations[e.index] == e.generation;
+  return e.index != 0 && e.index < m_records.count && m_records[e.index].alive &&
+         m_records[e.index].generation == e.generation;
 }
 
 template<typename ExtraComponents>
@@ -277,43 +1091,25 @@ inline uint32_t EntityManager<ExtraComponents>::pop_free_list() {
 
 template<typename ExtraComponents>
 inline void EntityManager<ExtraComponents>::serialize(Serializer& s) const {
-  s.write(static_cast<U32>(m_generations.count));
-  for (U64 i = 0; i < m_generations.count; ++i)
-    s.write(m_generations[i]);
+  s.write(static_cast<U32>(m_records.count));
+  for (U64 i = 0; i < m_records.count; ++i)
+    s.write(m_records[i].generation);
+  s.write(m_generation_floor);
 
   s.write(static_cast<U32>(m_free_list.count));
   for (U64 i = 0; i < m_free_list.count; ++i)
     s.write(m_free_list[i]);
 
-  const auto& mask_entities = m_entity_masks.get_dense_entities();
-  U32         aliveCount    = 0;
-  for (U64 i = 0; i < mask_entities.count; ++i) {
-    if (is_alive(mask_entities[i]))
-      aliveCount++;
-  }
-  s.write(aliveCount);
-
-  for (U64 i = 0; i < mask_entities.count; ++i) {
-    Entity e = mask_entities[i];
-    if (!is_alive(e))
+  s.write(static_cast<U32>(m_alive_count));
+  for (U64 i = 0; i < m_records.count; ++i) {
+    const EntityRecord& record = m_records[i];
+    if (!record.alive)
       continue;
 
-    s.write(e.index);
-    s.write(e.generation);
-    const ComponentMask* mask = m_entity_masks.get(e);
-    if (mask) {
-      for (USize word = 0; word < 4; ++word) {
-        U64 packed = 0;
-        for (USize bit = 0; bit < 64; ++bit) {
-          if (mask->test(word * 64 + bit))
-            packed |= (U64(1) << bit);
-        }
-        s.write(packed);
-      }
-    } else {
-      for (USize i = 0; i < 4; ++i)
-        s.write(static_cast<U64>(0));
-    }
+    s.write(static_cast<U32>(i));
+    s.write(record.generation);
+    for (USize word = 0; word < SERIALIZED_MASK_WORDS; ++word)
+      s.write(word < ComponentMask::WORD_COUNT ? record.mask.words[word] : U64{0});
   }
 
   U32 serializable_count = 0;
@@ -336,7 +1132,9 @@ inline void EntityManager<ExtraComponents>::deserialize(Serializer& s) {
   {
     U32 count = s.read<U32>();
     for (U32 i = 0; i < count; ++i)
-      m_generations.push(m_pool_arena, s.read<U32>());
+      m_records.push(m_pool_arena,
+                     EntityRecord{.generation = s.read<U32>(), .alive = 0, .mask = {}});
+    m_generation_floor = max(m_generation_floor, s.read<U32>());
   }
 
   {
@@ -345,45 +1143,41 @@ inline void EntityManager<ExtraComponents>::deserialize(Serializer& s) {
       m_free_list.push(m_pool_arena, s.read<U32>());
   }
 
-  U32 maskCount        = s.read<U32>();
-  m_entity_masks.arena = m_pool_arena;
-  for (U32 i = 0; i < maskCount; ++i) {
-    U32    index      = s.read<U32>();
-    U32    generation = s.read<U32>();
-    Entity e{index, generation};
-    m_entity_masks.add(e, ComponentMask{});
-    ComponentMask* mask = m_entity_masks.get(e);
-    if (mask) {
-      for (USize word = 0; word < 4; ++word) {
-        U64 packed = s.read<U64>();
-        for (USize bit = 0; bit < 64; ++bit) {
-          if (packed & (static_cast<U64>(1) << bit))
-            mask->set(word * 64 + bit);
-        }
-      }
-    } else {
-      for (USize j = 0; j < 4; ++j)
-        s.read<U64>();
-    }
-  }
+  U32 alive_count = s.read<U32>();
+  for (U32 i = 0; i < alive_count; ++i) {
+    U32 index      = s.read<U32>();
+    U32 generation = s.read<U32>();
+    assert(index < m_records.count && m_records[index].generation == generation &&
+           "Serialized entity does not match its generation");
+    (void)generation;
 
-  for (U32 i = 0; i < m_free_list.count; ++i) {
-    assert(m_generations[m_free_list[i]] > 0 && "Freelist index has generation 0");
-    Entity e{m_free_list[i], m_generations[m_free_list[i]] - 1};
-    m_entity_masks.add(e, ComponentMask{});
+    EntityRecord& record = m_records[index];
+    record.alive         = 1;
+    for (USize word = 0; word < SERIALIZED_MASK_WORDS; ++word) {
+      U64 bits = s.read<U64>();
+      if (word < ComponentMask::WORD_COUNT)
+        record.mask.words[word] = bits;
+    }
   }
+  m_alive_count += alive_count;
 
   U32 serializable_count = s.read<U32>();
-  m_component_pools.clear();
 
   for (U32 i = 0; i < serializable_count; ++i) {
     U32  componentId = s.read<U32>();
     auto entry       = sd::ComponentFactory::create(componentId, m_pool_arena);
     if (entry.pool) {
       entry.deserialize_fn(entry.pool, s);
-      if (componentId >= m_component_pools.count)
-        m_component_pools.push(m_pool_arena, ComponentPoolNode{});
-      m_component_pools[componentId] = entry;
+      // Only the pool is replaced, observers and tags registered before loading stay attached
+      ComponentPoolNode& node = ensure_node(componentId);
+      assert(!node.group && "Groups must be created after deserialize");
+      node.pool             = entry.pool;
+      node.remove_fn        = entry.remove_fn;
+      node.serialize_fn     = entry.serialize_fn;
+      node.deserialize_fn   = entry.deserialize_fn;
+      node.clear_changed_fn = entry.clear_changed_fn;
+      node.stats_fn         = entry.stats_fn;
+      node.compact_fn       = entry.compact_fn;
     }
   }
 }
@@ -0,0 +1,47 @@
+#pragma once
+
+template<typename ExtraComponents>
+const RenderSnapshot* extract_render_snapshot(EntityManager<ExtraComponents>& em, Arena* arena) {
+  using components::Camera;
+  using components::Renderable;
+  using components::Transform;
+  using Manager   = EntityManager<ExtraComponents>;
+  using Drawables = GroupImpl<ExtraComponents, Transform, Renderable>;
+
+  auto* snapshot   = new (arena_push_no_zero<RenderSnapshot>(arena)) RenderSnapshot{};
+  auto* transforms = em.template get_component_pool<Transform>();
+  auto* renderable = em.template get_component_pool<Renderable>();
+
+  if (transforms && renderable) {
+    const ComponentPoolNode& node =
+        em.m_component_pools[Manager::template component_info<Transform>::id()];
+    if (node.group && node.group_on_add_fn == &Drawables::on_add) {
+      // The group keeps every drawable in the same dense prefix of both pools
+      const USize count = static_cast<const Drawables*>(node.group)->size();
+      snapshot->entities.reserve(arena, count);
+      snapshot->transforms.reserve(arena, count);
+      transforms->dense_entities.copy_to(snapshot->entities.data, 0, count);
+      transforms->dense_data.copy_to(snapshot->transforms.data, 0, count);
+      snapshot->entities.count   = count;
+      snapshot->transforms.count = count;
+      snapshot->renderables.append(arena, renderable->dense_data, 0, count);
+    } else {
+      for ([[maybe_unused]] auto [e, transform, r] : em.template view<Transform, Renderable>()) {
+        snapshot->entities.push(arena, e);
+        snapshot->transforms.push(arena, transform);
+        snapshot->renderables.push(arena, renderable->dense_data.load(renderable->sparse_at(e)));
+      }
+    }
+  }
+
+  if (auto* cameras = em.template get_component_pool<Camera>()) {
+    const USize count = cameras->size();
+    snapshot->camera_entities.reserve(arena, count);
+    snapshot->cameras.reserve(arena, count);
+    cameras->dense_entities.copy_to(snapshot->camera_entities.data, 0, count);
+    cameras->dense_data.copy_to(snapshot->cameras.data, 0, count);
+    snapshot->camera_entities.count = count;
+    snapshot->cameras.count         = count;
+  }
+  return snapshot;
+}
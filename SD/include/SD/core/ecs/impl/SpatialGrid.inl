@@ -0,0 +1,467 @@
+#pragma once
+
+template<typename ExtraComponents>
+SpatialGrid<ExtraComponents>::SpatialGrid(manager_type& manager, Arena* arena, F32 cell_size) :
+  m_manager(manager), m_arena(arena), m_cell_size(cell_size), m_inv_cell_size(1.0f / cell_size) {
+  using components::BoundingSphere;
+  using components::Transform;
+
+  assert(cell_size > 0.0f && "Cell size must be positive");
+  m_manager.template track_changes<Transform>();
+  m_manager.template track_changes<BoundingSphere>();
+  m_manager.template observe<Transform>(
+      ComponentEvent::Destroy, ComponentObserver{.fn = &on_transform_destroyed, .user = this});
+  m_manager.template observe<BoundingSphere>(
+      ComponentEvent::Destroy, ComponentObserver{.fn = &on_bounds_destroyed, .user = this});
+
+  if (auto* transforms = m_manager.template get_component_pool<Transform>()) {
+    Temp                    scratch  = scratch_begin(m_arena);
+    const PagedVec<Entity>& all      = transforms->get_dense_entities();
+    Entity*                 entities = scratch.arena->push_array_no_zero<Entity>(all.count);
+    all.copy_to(entities, 0, all.count);
+    rebucket({entities, all.count}, scratch.arena, nullptr, all.count);
+    scratch_end(scratch);
+  }
+}
+
+template<typename ExtraComponents>
+SpatialGrid<ExtraComponents>::~SpatialGrid() {
+  using components::BoundingSphere;
+  using components::Transform;
+
+  m_manager.template unobserve<Transform>(
+      ComponentEvent::Destroy, ComponentObserver{.fn = &on_transform_destroyed, .user = this});
+  m_manager.template unobserve<BoundingSphere>(
+      ComponentEvent::Destroy, ComponentObserver{.fn = &on_bounds_destroyed, .user = this});
+}
+
+template<typename ExtraComponents>
+typename SpatialGrid<ExtraComponents>::CellKey
+SpatialGrid<ExtraComponents>::key_of(F32 x, F32 y, F32 z) const {
+  return CellKey{.x = static_cast<I32>(std::floor(x * m_inv_cell_size)),
+                 .y = static_cast<I32>(std::floor(y * m_inv_cell_size)),
+                 .z = static_cast<I32>(std::floor(z * m_inv_cell_size))};
+}
+
+template<typename ExtraComponents>
+U64 SpatialGrid<ExtraComponents>::hash_of(const CellKey& key) {
+  const U64 h = (static_cast<U64>(static_cast<U32>(key.x)) * 73856093u) ^
+                (static_cast<U64>(static_cast<U32>(key.y)) * 19349663u) ^
+                (static_cast<U64>(static_cast<U32>(key.z)) * 83492791u);
+  // Neighbouring keys differ in few bits, spread them over the bits the table mask keeps
+  return (h * 0x9E3779B97F4A7C15ull) >> 20;
+}
+
+template<typename ExtraComponents>
+U32 SpatialGrid<ExtraComponents>::find_cell(const CellKey& key) const {
+  if (m_table.count == 0)
+    return NO_CELL;
+  const U64 mask = m_table.count - 1;
+  for (U64 bucket = hash_of(key) & mask;; bucket = (bucket + 1) & mask) {
+    const Bucket& entry = m_table[bucket];
+    if (entry.cell == NO_CELL || entry.key == key)
+      return entry.cell;
+  }
+}
+
+template<typename ExtraComponents>
+U32 SpatialGrid<ExtraComponents>::ensure_cell(const CellKey& key) {
+  const U32 found = find_cell(key);
+  if (found != NO_CELL)
+    return found;
+
+  U32 cell;
+  if (m_free_cells.count > 0) {
+    cell = m_free_cells[--m_free_cells.count];
+  } else {
+    // Every cell may be in the table at once, keep it at most half full
+    if ((m_cells.count + 1) * 2 > m_table.count)
+      grow_table();
+    cell = static_cast<U32>(m_cells.count);
+    m_cells.push(m_arena, Cell{});
+  }
+  m_cells[cell].key = key;
+
+  const U64 mask   = m_table.count - 1;
+  U64       bucket = hash_of(key) & mask;
+  while (m_table[bucket].cell != NO_CELL)
+    bucket = (bucket + 1) & mask;
+  m_table[bucket] = Bucket{.key = key, .cell = cell};
+  return cell;
+}
+
+template<typename ExtraComponents>
+void SpatialGrid<ExtraComponents>::release_cell(U32 cell) {
+  const U64 mask   = m_table.count - 1;
+  U64       bucket = hash_of(m_cells[cell].key) & mask;
+  while (m_table[bucket].cell != cell)
+    bucket = (bucket + 1) & mask;
+
+  // Backward shift deletion: later entries of the probe run move into the hole unless that would
+  // put them before their home bucket, so no tombstones are left behind
+  for (U64 next = (bucket + 1) & mask; m_table[next].cell != NO_CELL; next = (next + 1) & mask) {
+    const U64 home = hash_of(m_table[next].key) & mask;
+    if (((next - home) & mask) >= ((next - bucket) & mask)) {
+      m_table[bucket] = m_table[next];
+      bucket          = next;
+    }
+  }
+  m_table[bucket].cell = NO_CELL;
+  m_free_cells.push(m_arena, cell);
+}
+
+template<typename ExtraComponents>
+void SpatialGrid<ExtraComponents>::grow_table() {
+  const U64 size = m_table.count ? m_table.count * 2 : 64;
+  m_table.clear();
+  m_table.reserve(m_arena, size);
+  m_table.count = size;
+  std::fill_n(m_table.data, size, Bucket{});
+
+  const U64 mask = size - 1;
+  for (U32 cell = 0; cell < m_cells.count; ++cell) {
+    if (m_cells[cell].entities.count == 0)
+      continue;
+    U64 bucket = hash_of(m_cells[cell].key) & mask;
+    while (m_table[bucket].cell != NO_CELL)
+      bucket = (bucket + 1) & mask;
+    m_table[bucket] = Bucket{.key = m_cells[cell].key, .cell = cell};
+  }
+}
+
+template<typename ExtraComponents>
+void SpatialGrid<ExtraComponents>::rebucket(std::span<const Entity> entities,
+                                            Arena*                  scratch,
+                                            JobSystem*              jobs,
+                                            USize                   grain) {
+  using components::BoundingSphere;
+  using components::Transform;
+
+  if (entities.empty())
+    return;
+  auto*       transforms = m_manager.template get_component_pool<Transform>();
+  const auto* bounds     = m_manager.template get_component_pool<BoundingSphere>();
+
+  // The parallel pass writes spheres and reads slots, every one it can touch must exist first
+  U32 last_index = 0;
+  for (const Entity e : entities)
+    last_index = std::max(last_index, e.index);
+  while (m_slots.count <= last_index) {
+    m_slots.push(m_arena, Slot{});
+    m_spheres.push(m_arena, Sphere{});
+  }
+
+  // Each entity writes only its own sphere, so chunks never touch the same memory
+  Placement* placements = scratch->push_array_no_zero<Placement>(entities.size());
+  auto       refresh    = [&](USize first, USize last) {
+    for (USize i = first; i < last; ++i) {
+      const Entity e     = entities[i];
+      const auto&  world = transforms->dense_data[transforms->sparse_at(e)].world_matrix;
+      F32          radius = 0.0f;
+      if (bounds) {
+        const U32 dense = bounds->sparse_at(e);
+        if (dense != SPARSE_NONE)
+          radius = bounds->dense_data[dense].radius;
+      }
+
+      const F32     x         = world(0, 3);
+      const F32     y         = world(1, 3);
+      const F32     z         = world(2, 3);
+      const CellKey key       = key_of(x, y, z);
+      const Slot    slot      = m_slots[e.index];
+      const bool    oversized = radius > m_cell_size;
+      const bool    stays     = oversized ? slot.cell == OVERSIZED
+                                          : slot.cell != NO_CELL && slot.cell != OVERSIZED &&
+                                                slot.key == key;
+      m_spheres[e.index] = Sphere{.x = x, .y = y, .z = z, .radius = radius};
+      placements[i]      = Placement{.key = key, .moves = !stays};
+    }
+  };
+  if (jobs && entities.size() >= grain * 2)
+    jobs->parallel_for(entities.size(), grain, refresh);
+  else
+    refresh(0, entities.size());
+
+  for (USize i = 0; i < entities.size(); ++i) {
+    if (placements[i].moves)
+      relink(entities[i], placements[i].key, m_spheres[entities[i].index].radius > m_cell_size);
+  }
+}
+
+template<typename ExtraComponents>
+void SpatialGrid<ExtraComponents>::relink(Entity e, const CellKey& key, bool oversized) {
+  unlink(e);
+  const U32 cell   = oversized ? OVERSIZED : ensure_cell(key);
+  Cell&     target = cell_at(cell);
+  m_slots[e.index] = Slot{.key = key, .cell = cell, .row = static_cast<U32>(target.entities.count)};
+  target.entities.push(m_arena, e);
+  m_size++;
+}
+
+template<typename ExtraComponents>
+void SpatialGrid<ExtraComponents>::unlink(Entity e) {
+  if (e.index >= m_slots.count || m_slots[e.index].cell == NO_CELL)
+    return;
+
+  const Slot slot = m_slots[e.index];
+  Cell&      cell = cell_at(slot.cell);
+  const U64  last = cell.entities.count - 1;
+  if (slot.row != last) {
+    const Entity moved       = cell.entities[last];
+    cell.entities[slot.row]  = moved;
+    m_slots[moved.index].row = slot.row;
+  }
+  cell.entities.count--;
+  if (cell.entities.count == 0 && slot.cell != OVERSIZED)
+    release_cell(slot.cell);
+  m_slots[e.index] = Slot{};
+  m_size--;
+}
+
+template<typename ExtraComponents>
+void SpatialGrid<ExtraComponents>::update(JobSystem* jobs, USize grain) {
+  using components::BoundingSphere;
+  using components::Transform;
+
+  auto* transforms = m_manager.template get_component_pool<Transform>();
+  if (!transforms)
+    return;
+  auto* bounds = m_manager.template get_component_pool<BoundingSphere>();
+
+  Temp                    scratch = scratch_begin(m_arena);
+  const PagedVec<Entity>& moved   = transforms->get_changed_entities();
+  const USize             resized = bounds ? bounds->get_changed_entities().count : 0;
+  ArenaVec<Entity>        entities;
+  entities.reserve(scratch.arena, moved.count + resized);
+  moved.copy_to(entities.data, 0, moved.count);
+  entities.count = moved.count;
+  for (USize i = 0; i < resized; ++i) {
+    // Entities without a Transform are not in the grid, those whose Transform changed are listed
+    const Entity e     = bounds->get_changed_entities()[i];
+    const U32    dense = transforms->sparse_at(e);
+    if (dense != SPARSE_NONE && transforms->dense_changed[dense] == SPARSE_NONE)
+      entities.push(scratch.arena, e);
+  }
+
+  rebucket({entities.data, entities.count}, scratch.arena, jobs, grain);
+  scratch_end(scratch);
+}
+
+template<typename ExtraComponents>
+template<typename Test, typename Fn>
+void SpatialGrid<ExtraComponents>::overlap_rows(const Cell& cell, Test&& test, Fn&& fn) const {
+  const USize count = cell.entities.count;
+  for (USize base = 0; base < count; base += BATCH) {
+    const USize n = std::min(BATCH, count - base);
+    Sphere      batch[BATCH];
+    bool        hit[BATCH];
+    for (USize i = 0; i < n; ++i)
+      batch[i] = m_spheres[cell.entities[base + i].index];
+    for (USize i = 0; i < n; ++i)
+      hit[i] = test(batch[i]);
+    for (USize i = 0; i < n; ++i) {
+      if (hit[i])
+        fn(base + i);
+    }
+  }
+}
+
+template<typename ExtraComponents>
+template<typename Fn>
+void SpatialGrid<ExtraComponents>::overlap_sphere(
+    const Cell& cell, F32 cx, F32 cy, F32 cz, F32 radius, Fn&& fn) const {
+  overlap_rows(
+      cell,
+      [=](const Sphere& sphere) {
+        const F32 dx    = sphere.x - cx;
+        const F32 dy    = sphere.y - cy;
+        const F32 dz    = sphere.z - cz;
+        const F32 reach = sphere.radius + radius;
+        return dx * dx + dy * dy + dz * dz <= reach * reach;
+      },
+      fn);
+}
+
+template<typename ExtraComponents>
+template<typename Fn>
+void SpatialGrid<ExtraComponents>::overlap_box(const Cell&          cell,
+                                               const VLA::Vector3f& min,
+                                               const VLA::Vector3f& max,
+                                               Fn&&                 fn) const {
+  // Distance from the center to the box against the radius, the box is a sphere of radius 0
+  // around the clamped point. std::clamp is branchless on floats, so the batch still vectorizes
+  overlap_rows(
+      cell,
+      [&](const Sphere& sphere) {
+        const F32 dx = sphere.x - std::clamp(sphere.x, min[0], max[0]);
+        const F32 dy = sphere.y - std::clamp(sphere.y, min[1], max[1]);
+        const F32 dz = sphere.z - std::clamp(sphere.z, min[2], max[2]);
+        return dx * dx + dy * dy + dz * dz <= sphere.radius * sphere.radius;
+      },
+      fn);
+}
+
+template<typename ExtraComponents>
+template<typename Fn>
+void SpatialGrid<ExtraComponents>::for_cells(const CellKey& lo, const CellKey& hi, Fn&& fn) {
+  const U64 volume = static_cast<U64>(hi.x - lo.x + 1) * static_cast<U64>(hi.y - lo.y + 1) *
+                     static_cast<U64>(hi.z - lo.z + 1);
+  // A range wider than the populated grid is cheaper to answer by walking the cells
+  if (volume > m_cells.count) {
+    for (Cell& cell : m_cells) {
+      const CellKey& key = cell.key;
+      if (key.x >= lo.x && key.x <= hi.x && key.y >= lo.y && key.y <= hi.y && key.z >= lo.z &&
+          key.z <= hi.z)
+        fn(cell);
+    }
+    return;
+  }
+  for (I32 x = lo.x; x <= hi.x; ++x) {
+    for (I32 y = lo.y; y <= hi.y; ++y) {
+      for (I32 z = lo.z; z <= hi.z; ++z) {
+        const U32 cell = find_cell(CellKey{.x = x, .y = y, .z = z});
+        if (cell != NO_CELL)
+          fn(m_cells[cell]);
+      }
+    }
+  }
+}
+
+template<typename ExtraComponents>
+std::span<Entity> SpatialGrid<ExtraComponents>::query_aabb(const VLA::Vector3f& min,
+                                                           const VLA::Vector3f& max,
+                                                           Arena*               out) {
+  ArenaVec<Entity> result;
+  // Spheres in cells are at most a cell wide
+  const F32     reach = m_cell_size;
+  const CellKey lo    = key_of(min[0] - reach, min[1] - reach, min[2] - reach);
+  const CellKey hi    = key_of(max[0] + reach, max[1] + reach, max[2] + reach);
+
+  auto collect = [&](const Cell& cell) {
+    overlap_box(cell, min, max, [&](USize row) { result.push(out, cell.entities[row]); });
+  };
+  for_cells(lo, hi, collect);
+  collect(m_oversized);
+  return {result.data, result.count};
+}
+
+template<typename ExtraComponents>
+std::span<Entity> SpatialGrid<ExtraComponents>::query_radius(const VLA::Vector3f& center,
+                                                             F32                  radius,
+                                                             Arena*               out) {
+  ArenaVec<Entity> result;
+  const F32        reach = radius + m_cell_size;
+  const CellKey    lo    = key_of(center[0] - reach, center[1] - reach, center[2] - reach);
+  const CellKey    hi    = key_of(center[0] + reach, center[1] + reach, center[2] + reach);
+
+  auto collect = [&](const Cell& cell) {
+    overlap_sphere(cell, center[0], center[1], center[2], radius, [&](USize row) {
+      result.push(out, cell.entities[row]);
+    });
+  };
+  for_cells(lo, hi, collect);
+  collect(m_oversized);
+  return {result.data, result.count};
+}
+
+template<typename ExtraComponents>
+std::span<Entity> SpatialGrid<ExtraComponents>::raycast(const VLA::Vector3f& origin,
+                                                        const VLA::Vector3f& dir,
+                                                        F32                  max_distance,
+                                                        Arena*               out) {
+  assert(std::isfinite(max_distance) && "Rays are walked cell by cell and need an end");
+  if (m_size == 0)
+    return {};
+
+  ArenaVec<Hit> hits;
+  const U32     stamp = ++m_stamp;
+
+  auto test_cell = [&](Cell& cell) {
+    if (cell.stamp == stamp)
+      return;
+    cell.stamp = stamp;
+    for (USize i = 0; i < cell.entities.count; ++i) {
+      // Closest approach of the ray to the center, then back off to the sphere surface
+      const Sphere& sphere = m_spheres[cell.entities[i].index];
+      const F32     ox     = sphere.x - origin[0];
+      const F32     oy     = sphere.y - origin[1];
+      const F32     oz     = sphere.z - origin[2];
+      const F32     t      = ox * dir[0] + oy * dir[1] + oz * dir[2];
+      const F32     d2     = ox * ox + oy * oy + oz * oz - t * t;
+      const F32     r2     = sphere.radius * sphere.radius;
+      if (d2 > r2)
+        continue;
+      const F32 entry = t - std::sqrt(r2 - d2);
+      if (t + std::sqrt(r2 - d2) < 0.0f || entry > max_distance)
+        continue;
+      hits.push(out, Hit{.distance = std::max(entry, 0.0f), .entity = cell.entities[i]});
+    }
+  };
+
+  // Amanatides-Woo traversal of the cells along the ray
+  constexpr F32 NEVER = std::numeric_limits<F32>::infinity();
+  const CellKey start = key_of(origin[0], origin[1], origin[2]);
+  I32           at[3] = {start.x, start.y, start.z};
+  I32           step[3];
+  F32           next[3];
+  F32           delta[3];
+  for (int axis = 0; axis < 3; ++axis) {
+    step[axis]  = dir[axis] >= 0.0f ? 1 : -1;
+    delta[axis] = dir[axis] != 0.0f ? std::abs(m_cell_size / dir[axis]) : NEVER;
+    const F32 boundary = static_cast<F32>(at[axis] + (step[axis] > 0 ? 1 : 0)) * m_cell_size;
+    next[axis]         = dir[axis] != 0.0f ? (boundary - origin[axis]) / dir[axis] : NEVER;
+  }
+
+  // Spheres in cells are at most a cell wide, so only the neighbours of a visited cell can reach
+  // the ray. The first cell scans its whole neighbourhood, every step after that only the face of
+  // it the step moved into, the rest was scanned already
+  auto scan = [&](const I32 (&lo)[3], const I32 (&hi)[3]) {
+    for (I32 x = lo[0]; x <= hi[0]; ++x) {
+      for (I32 y = lo[1]; y <= hi[1]; ++y) {
+        for (I32 z = lo[2]; z <= hi[2]; ++z) {
+          const U32 cell = find_cell(CellKey{.x = x, .y = y, .z = z});
+          if (cell != NO_CELL)
+            test_cell(m_cells[cell]);
+        }
+      }
+    }
+  };
+  test_cell(m_oversized);
+  scan({at[0] - 1, at[1] - 1, at[2] - 1}, {at[0] + 1, at[1] + 1, at[2] + 1});
+
+  for (;;) {
+    const int axis =
+        next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+    // A sphere entered by max_distance is a neighbour of a cell the ray entered by then
+    if (next[axis] > max_distance)
+      break;
+    at[axis] += step[axis];
+    next[axis] += delta[axis];
+
+    I32 lo[3] = {at[0] - 1, at[1] - 1, at[2] - 1};
+    I32 hi[3] = {at[0] + 1, at[1] + 1, at[2] + 1};
+    lo[axis] = hi[axis] = at[axis] + step[axis];
+    scan(lo, hi);
+  }
+
+  std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+    return a.distance < b.distance;
+  });
+  Entity* result = out->push_array_no_zero<Entity>(hits.count);
+  for (USize i = 0; i < hits.count; ++i)
+    result[i] = hits[i].entity;
+  return {result, hits.count};
+}
+
+template<typename ExtraComponents>
+void SpatialGrid<ExtraComponents>::on_transform_destroyed(void* self, Entity e) {
+  static_cast<SpatialGrid*>(self)->unlink(e);
+}
+
+template<typename ExtraComponents>
+void SpatialGrid<ExtraComponents>::on_bounds_destroyed(void* self, Entity e) {
+  auto* grid = static_cast<SpatialGrid*>(self);
+  // An oversized entry stays in m_oversized until its next update, which is still correct
+  if (e.index < grid->m_spheres.count)
+    grid->m_spheres[e.index].radius = 0.0f;
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+template<typename ExtraComponents>
+TransformHierarchy<ExtraComponents>::TransformHierarchy(manager_type& manager, Arena* arena) :
+  m_manager(manager), m_arena(arena) {
+  using components::LocalTransform;
+  using components::Parent;
+  using components::Transform;
+
+  m_manager.template track_changes<LocalTransform>();
+
+  const ComponentObserver structure{.fn = &on_structure_changed, .user = this};
+  m_manager.template observe<LocalTransform>(ComponentEvent::Construct, structure);
+  m_manager.template observe<LocalTransform>(ComponentEvent::Destroy, structure);
+  m_manager.template observe<Transform>(ComponentEvent::Construct, structure);
+  m_manager.template observe<Transform>(ComponentEvent::Destroy, structure);
+  m_manager.template observe<components::Children>(ComponentEvent::Destroy, structure);
+  m_manager.template observe<Parent>(ComponentEvent::Destroy,
+                                     ComponentObserver{.fn = &on_parent_removed, .user = this});
+}
+
+template<typename ExtraComponents>
+TransformHierarchy<ExtraComponents>::~TransformHierarchy() {
+  using components::LocalTransform;
+  using components::Parent;
+  using components::Transform;
+
+  const ComponentObserver structure{.fn = &on_structure_changed, .user = this};
+  m_manager.template unobserve<LocalTransform>(ComponentEvent::Construct, structure);
+  m_manager.template unobserve<LocalTransform>(ComponentEvent::Destroy, structure);
+  m_manager.template unobserve<Transform>(ComponentEvent::Construct, structure);
+  m_manager.template unobserve<Transform>(ComponentEvent::Destroy, structure);
+  m_manager.template unobserve<components::Children>(ComponentEvent::Destroy, structure);
+  m_manager.template unobserve<Parent>(ComponentEvent::Destroy,
+                                       ComponentObserver{.fn = &on_parent_removed, .user = this});
+}
+
+template<typename ExtraComponents>
+void TransformHierarchy<ExtraComponents>::set_parent(Entity child, Entity parent) {
+  using components::Children;
+  using components::Parent;
+
+  assert(m_manager.is_alive(child) && "Parenting a dead entity");
+  if (auto* current = m_manager.template try_get_component<Parent>(child)) {
+    if (current->entity == parent)
+      return;
+    // The Destroy observer unlinks it from the old parent
+    m_manager.template try_remove_component<Parent>(child);
+  }
+  m_order_dirty = true;
+  if (parent.index == 0)
+    return;
+
+  assert(m_manager.is_alive(parent) && "Parenting to a dead entity");
+  assert(child != parent && !is_ancestor(child, parent) && "Parenting would create a cycle");
+
+  auto* children = m_manager.template try_get_component<Children>(parent);
+  if (!children)
+    children = m_manager.template add_component<Children>(parent);
+
+  m_manager.template add_component<Parent>(
+      child, Parent{.entity = parent, .prev_sibling = {}, .next_sibling = children->first});
+  if (children->first.index != 0)
+    m_manager.template get_component<Parent>(children->first).prev_sibling = child;
+  children->first = child;
+  children->count++;
+}
+
+template<typename ExtraComponents>
+bool TransformHierarchy<ExtraComponents>::is_ancestor(Entity ancestor, Entity e) const {
+  while (const auto* parent = m_manager.template try_get_component<components::Parent>(e)) {
+    if (parent->entity == ancestor)
+      return true;
+    e = parent->entity;
+  }
+  return false;
+}
+
+template<typename ExtraComponents>
+void TransformHierarchy<ExtraComponents>::on_structure_changed(void* self, Entity) {
+  static_cast<TransformHierarchy*>(self)->m_order_dirty = true;
+}
+
+template<typename ExtraComponents>
+void TransformHierarchy<ExtraComponents>::on_parent_removed(void* self, Entity e) {
+  using components::Children;
+  using components::Parent;
+
+  auto*         hierarchy  = static_cast<TransformHierarchy*>(self);
+  manager_type& em         = hierarchy->m_manager;
+  hierarchy->m_order_dirty = true;
+
+  const Parent& link = em.template get_component<Parent>(e);
+  if (link.prev_sibling.index != 0)
+    em.template get_component<Parent>(link.prev_sibling).next_sibling = link.next_sibling;
+  if (link.next_sibling.index != 0)
+    em.template get_component<Parent>(link.next_sibling).prev_sibling = link.prev_sibling;
+
+  // A parent being destroyed may already have lost its Children
+  if (auto* children = em.template try_get_component<Children>(link.entity)) {
+    if (children->first == e)
+      children->first = link.next_sibling;
+    children->count--;
+  }
+}
+
+template<typename ExtraComponents>
+void TransformHierarchy<ExtraComponents>::rebuild() {
+  using components::Children;
+  using components::LocalTransform;
+  using components::Parent;
+  using components::Transform;
+
+  // Keep the arrays, a rebuild reuses their capacity
+  m_nodes.count  = 0;
+  m_levels.count = 0;
+  m_order_dirty  = false;
+
+  const USize entity_slots = static_cast<USize>(m_manager.m_records.count);
+  m_slot_of.reserve(m_arena, entity_slots);
+  m_slot_of.count = entity_slots;
+  std::fill_n(m_slot_of.data, entity_slots, NO_NODE);
+
+  auto in_hierarchy = [&](Entity e) {
+    return m_manager.template has_component<LocalTransform>(e) &&
+           m_manager.template has_component<Transform>(e);
+  };
+  auto push_node = [&](Entity e, U32 parent) {
+    m_slot_of[e.index] = static_cast<U32>(m_nodes.count);
+    m_nodes.push(m_arena,
+                 Node{.entity = e,
+                      .parent = parent,
+                      .world  = &m_manager.template get_component<Transform>(e),
+                      .local  = &m_manager.template get_component<LocalTransform>(e)});
+  };
+
+  // Roots are entities without a parent in the hierarchy, including orphans of destroyed parents
+  for ([[maybe_unused]] auto [e, local, transform] :
+       m_manager.template view<LocalTransform, Transform>()) {
+    const auto* parent = m_manager.template try_get_component<Parent>(e);
+    if (!parent || !in_hierarchy(parent->entity))
+      push_node(e, NO_NODE);
+  }
+
+  // Breadth-first, each pass over [begin, end) appends the next depth
+  USize begin = 0;
+  while (begin < m_nodes.count) {
+    const USize end = m_nodes.count;
+    m_levels.push(m_arena, static_cast<U32>(begin));
+    for (USize i = begin; i < end; ++i) {
+      const auto* children = m_manager.template try_get_component<Children>(m_nodes[i].entity);
+      if (!children)
+        continue;
+      Entity child = children->first;
+      for (U32 k = 0; k < children->count; ++k) {
+        if (in_hierarchy(child))
+          push_node(child, static_cast<U32>(i));
+        child = m_manager.template get_component<Parent>(child).next_sibling;
+      }
+    }
+    begin = end;
+  }
+  m_levels.push(m_arena, static_cast<U32>(m_nodes.count));
+
+  m_world.reserve(m_arena, m_nodes.count);
+  m_world.count = m_nodes.count;
+  m_dirty.reserve(m_arena, m_nodes.count);
+  m_dirty.count = m_nodes.count;
+  std::fill_n(m_dirty.data, m_dirty.count, U8{1});
+}
+
+template<typename ExtraComponents>
+void TransformHierarchy<ExtraComponents>::refresh_pointers() {
+  for (Node& node : m_nodes) {
+    node.world = &m_manager.template get_component<components::Transform>(node.entity);
+    node.local = &m_manager.template get_component<components::LocalTransform>(node.entity);
+  }
+}
+
+template<typename ExtraComponents>
+void TransformHierarchy<ExtraComponents>::update_range(USize begin, USize end) {
+  for (USize i = begin; i < end; ++i) {
+    const Node& node = m_nodes[i];
+    if (node.parent == NO_NODE) {
+      if (!m_dirty[i])
+        continue;
+      m_world[i] = node.local->matrix;
+    } else {
+      if (!m_dirty[i] && !m_dirty[node.parent])
+        continue;
+      m_dirty[i] = 1;
+      m_world[i] = m_world[node.parent] * node.local->matrix;
+    }
+    node.world->world_matrix = m_world[i];
+  }
+}
+
+template<typename ExtraComponents>
+void TransformHierarchy<ExtraComponents>::propagate(JobSystem* jobs, USize grain) {
+  using components::LocalTransform;
+  using components::Transform;
+
+  auto* locals     = m_manager.template get_component_pool<LocalTransform>();
+  auto* transforms = m_manager.template get_component_pool<Transform>();
+  if (!locals || !transforms)
+    return;
+
+  if (m_order_dirty) {
+    rebuild();
+  } else if (locals->reorder_count != m_local_reorders ||
+             transforms->reorder_count != m_transform_reorders) {
+    refresh_pointers();
+  }
+  m_local_reorders     = locals->reorder_count;
+  m_transform_reorders = transforms->reorder_count;
+
+  // Entities with a LocalTransform but no Transform are listed too, they have no node
+  const PagedVec<Entity>& changed = locals->get_changed_entities();
+  for (USize i = 0; i < changed.count; ++i) {
+    const U32 index = changed[i].index;
+    if (index < m_slot_of.count && m_slot_of[index] != NO_NODE)
+      m_dirty[m_slot_of[index]] = 1;
+  }
+
+  // Parents sit in the previous level, so the nodes of one level are independent
+  for (USize level = 0; level + 1 < m_levels.count; ++level) {
+    const USize begin = m_levels[level];
+    const USize count = m_levels[level + 1] - begin;
+    if (jobs && count >= grain * 2) {
+      jobs->parallel_for(count, grain, [&](USize first, USize last) {
+        update_range(begin + first, begin + last);
+      });
+    } else {
+      update_range(begin, begin + count);
+    }
+  }
+
+  for (USize i = 0; i < m_dirty.count; ++i) {
+    if (!m_dirty[i])
+      continue;
+    m_dirty[i] = 0;
+    if (transforms->track_changes)
+      transforms->mark_changed(transforms->sparse_at(m_nodes[i].entity));
+  }
+}
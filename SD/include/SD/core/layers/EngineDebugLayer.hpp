@@ -27,6 +27,9 @@ struct SD_EXPORT EngineDebugLayer : Panel {
   void display_view_info(View* selected_view);
   void display_scene_selector();
   void display_ecs_inspector();
+  void display_ecs_memory();
+  void display_arena_memory();
+  void dump_arena_csv();
   void display_event_log();
   void display_layout_menu();
   void display_save_layout_dialog();
@@ -68,6 +71,7 @@ struct SD_EXPORT EngineDebugLayer : Panel {
   bool m_show_event_log       = true;
   bool m_show_renderer_info   = true;
   bool m_show_context_overlay = false;
+  bool m_show_arena_memory    = false;
   void set_view_inspector_visible(bool visible) { m_show_view_inspector = visible; }
   void set_scene_inspector_visible(bool visible) { m_show_scene_inspector = visible; }
   void set_event_log_visible(bool visible) { m_show_event_log = visible; }
@@ -124,6 +128,12 @@ struct SD_EXPORT EngineDebugLayer : Panel {
 
   Scene* m_prev_scene_for_entity_count = nullptr;
   int    m_prev_entity_count           = -1;
+
+  // Periodic arena usage rows appended to ARENA_CSV_FILE
+  static constexpr const char* ARENA_CSV_FILE = "arena_stats.csv";
+  bool                         m_arena_csv_enabled  = false;
+  float                        m_arena_csv_interval = 5.0f;
+  float                        m_arena_csv_timer    = 0.0f;
 };
 
 } // namespace sd
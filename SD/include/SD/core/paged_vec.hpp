@@ -0,0 +1,156 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "SD/arena.hpp"
+#include "SD/core/arena_vec.hpp"
+
+// Elements in the first block, sized so it is about 256 bytes. A pool holding a handful of
+// entities then costs a few hundred bytes per vector instead of a full page worth of blocks
+template<typename T>
+inline constexpr U64 k_paged_vec_first_block = std::bit_floor(max<U64>(1, 256 / sizeof(T)));
+
+/**
+ * Arena backed vector made of blocks behind a block table. Block `b` holds FirstBlock << b
+ * elements, so small vectors stay small while large ones need only a few dozen blocks. Growing
+ * pushes one new block and never copies, so element addresses stay valid for the lifetime of the
+ * arena. Blocks emptied by pops are kept and refilled by later pushes.
+ */
+template<typename T, U64 FirstBlock = k_paged_vec_first_block<T>>
+struct PagedVec {
+  static_assert(std::has_single_bit(FirstBlock), "First block size must be a power of two");
+
+  static constexpr U64 FIRST_BLOCK = FirstBlock;
+  static constexpr U64 FIRST_SHIFT = std::countr_zero(FirstBlock);
+
+  ArenaVec<T*> blocks;
+  U64          count = 0;
+
+  // Elements block `b` holds
+  static constexpr U64 block_size(U64 b) { return FIRST_BLOCK << b; }
+  // Index of the first element of block `b`, also the elements blocks [0, b) hold together
+  static constexpr U64 block_start(U64 b) { return (FIRST_BLOCK << b) - FIRST_BLOCK; }
+  // Block holding element `i`, branch free so indexing stays cheap in hot loops
+  static constexpr U64 block_of(U64 i) {
+    return static_cast<U64>(std::bit_width((i >> FIRST_SHIFT) + 1)) - 1;
+  }
+
+  void push(Arena* arena, const T& item) {
+    if (count == capacity())
+      push_block(arena);
+    (*this)[count] = item;
+    ++count;
+  }
+
+  // Allocates blocks until `n` elements fit
+  void reserve(Arena* arena, U64 n) {
+    if (n == 0)
+      return;
+    blocks.reserve(arena, block_of(n - 1) + 1);
+    while (capacity() < n)
+      push_block(arena);
+  }
+
+  // Copies `n` elements to the end, one memcpy per block for trivially copyable T
+  void append(Arena* arena, const T* items, U64 n) {
+    reserve(arena, count + n);
+    while (n > 0) {
+      const U64 b      = block_of(count);
+      const U64 offset = count - block_start(b);
+      const U64 run    = min(n, block_size(b) - offset);
+      T*        dst    = blocks[b] + offset;
+      if constexpr (std::is_trivially_copyable_v<T>) {
+        std::memcpy(dst, items, run * sizeof(T));
+      } else {
+        for (U64 i = 0; i < run; ++i)
+          dst[i] = items[i];
+      }
+      items += run;
+      count += run;
+      n -= run;
+    }
+  }
+
+  // Appends `n` copies of `item`. Trivially copyable T is replicated with doubling memcpys per
+  // block
+  void fill(Arena* arena, const T& item, U64 n) {
+    reserve(arena, count + n);
+    while (n > 0) {
+      const U64 b      = block_of(count);
+      const U64 offset = count - block_start(b);
+      const U64 run    = min(n, block_size(b) - offset);
+      T*        dst    = blocks[b] + offset;
+      if constexpr (std::is_trivially_copyable_v<T>) {
+        std::memcpy(dst, &item, sizeof(T));
+        for (U64 done = 1; done < run; done *= 2)
+          std::memcpy(dst + done, dst, min(done, run - done) * sizeof(T));
+      } else {
+        for (U64 i = 0; i < run; ++i)
+          dst[i] = item;
+      }
+      count += run;
+      n -= run;
+    }
+  }
+
+  // Moves every element of `src` to the end, `src` is left holding moved-from elements
+  void move_from(Arena* arena, PagedVec& src) {
+    reserve(arena, count + src.count);
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      for (U64 b = 0; b < src.block_count(); ++b)
+        append(arena, src.block(b), min(block_size(b), src.count - block_start(b)));
+    } else {
+      for (U64 i = 0; i < src.count; ++i)
+        (*this)[count++] = std::move(src[i]);
+    }
+  }
+
+  // Copies `n` elements starting at `first` into `dst`, one memcpy per block for trivially
+  // copyable T
+  void copy_to(T* dst, U64 first, U64 n) const {
+    while (n > 0) {
+      const U64 b      = block_of(first);
+      const U64 offset = first - block_start(b);
+      const U64 run    = min(n, block_size(b) - offset);
+      const T*  src    = blocks[b] + offset;
+      if constexpr (std::is_trivially_copyable_v<T>) {
+        std::memcpy(dst, src, run * sizeof(T));
+      } else {
+        for (U64 i = 0; i < run; ++i)
+          dst[i] = src[i];
+      }
+      dst += run;
+      first += run;
+      n -= run;
+    }
+  }
+
+  void clear() {
+    blocks.clear();
+    count = 0;
+  }
+
+  // Contiguous elements of block `b`, block_size(b) of them except for the last block
+  T*       block(U64 b) { return blocks[b]; }
+  const T* block(U64 b) const { return blocks[b]; }
+  U64      block_count() const { return count == 0 ? 0 : block_of(count - 1) + 1; }
+  // Elements the allocated blocks hold, including blocks kept after pops
+  U64      capacity() const { return block_start(blocks.count); }
+
+  T& operator[](U64 i) {
+    const U64 b = block_of(i);
+    return blocks[b][i - block_start(b)];
+  }
+  const T& operator[](U64 i) const {
+    const U64 b = block_of(i);
+    return blocks[b][i - block_start(b)];
+  }
+
+  // Allocates the next block, twice the size of the one before it
+  void push_block(Arena* arena) {
+    blocks.push(arena, arena->push_array<T>(block_size(blocks.count)));
+  }
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "SD/arena.hpp"
+#include "SD/core/arena_vec.hpp"
+#include "SD/core/vulkan/VulkanContext.hpp"
+#include "SD/core/vulkan/vulkan_config.hpp"
+
+namespace sd {
+
+/**
+ * One frame arena per frame in flight. Memory pushed during a frame stays valid until every
+ * submission made in that frame has finished on the GPU, a slot is only cleared once the fences
+ * of its previous frame signaled.
+ */
+struct FrameArenaRing {
+  FrameArenaRing();
+  ~FrameArenaRing();
+
+  // Moves to the next slot, waits for its fences and clears its arena
+  Arena* begin_frame(vk::Device device);
+  // Records a submission of the current frame, the slot waits for `fence` before it is reused
+  void   track_submit(vk::Fence fence);
+  // Call after the device went idle, recorded fences may be destroyed past this point
+  void   forget_fences();
+
+  [[nodiscard]] Arena* current() const { return m_slots[m_index].arena; }
+
+
+  struct Slot {
+    Arena* arena = nullptr;
+    // Pushed on the slot's own arena, cleared together with it
+    ArenaVec<vk::Fence> fences;
+  };
+
+  Slot m_slots[g_max_frames_in_flight];
+  U32  m_index = 0;
+};
+
+} // namespace sd
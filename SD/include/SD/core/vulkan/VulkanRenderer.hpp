@@ -2,6 +2,7 @@
 
 #include "SD/core/FrameTimer.hpp"
 #include "SD/core/base.hpp"
+#include "FrameArenaRing.hpp"
 #include "VulkanContext.hpp"
 #include "VulkanWindow.hpp"
 #include "vulkan_config.hpp"
@@ -18,11 +19,16 @@ struct VulkanRenderer {
 
   void set_clear_color(const std::array<float, 4>& color) { m_clear_color = color; }
 
+  FrameArenaRing& frame_arenas() { return m_frame_arenas; }
+
 
   VulkanContext& ctx;
   VkDevice       m_device;
   FrameTimer&    m_timer;
 
+  // Every successful submit is tracked so the frame's arena outlives the GPU work
+  FrameArenaRing m_frame_arenas;
+
   std::array<float, 4> m_clear_color{0.1f, 0.1f, 0.1f, 1.0f};
 };
 } // namespace sd
@@ -145,6 +145,13 @@ struct Serializer {
     }
   }
 
+  // Read raw bytes
+  void read(void* data, const USize size) {
+    assert(m_read_offset + size <= get_written_size());
+    std::memcpy(data, m_buffer.data() + m_read_offset, size);
+    m_read_offset += size;
+  }
+
   // Read ADL-deserializable object
   template<HasDeserialize T>
   void read(T& obj) {
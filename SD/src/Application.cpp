@@ -72,13 +72,16 @@ ImVec4 apply_theme() {
 Application::Application(const ApplicationSpecification& spec, RuntimeStateManager* state_manager) :
   is_running(true), hot_reload_enabled(spec.enableHotReload), app_spec(spec),
   window_manager(nullptr), layout_manager(nullptr), scene_manager(), app_event_manager(),
-  state_manager(state_manager), timer(), m_glfw_ctx(nullptr), m_vulkan_ctx(nullptr),
-  m_renderer(nullptr), m_imgui_ctx(nullptr) {
+  state_manager(state_manager), timer(), m_job_system(nullptr), m_glfw_ctx(nullptr),
+  m_vulkan_ctx(nullptr), m_renderer(nullptr), m_imgui_ctx(nullptr) {
   engine_arena = arena_alloc(ArenaParams{
       .name = "EngineArena",
   });
   Arena* a     = engine_arena;
 
+  m_job_system = arena_push<JobSystem>(a);
+  new (m_job_system) JobSystem(a);
+
   m_glfw_ctx = arena_push<GlfwContext>(a);
   new (m_glfw_ctx) GlfwContext();
 
@@ -164,6 +167,9 @@ Application::~Application() {
   if (m_glfw_ctx) {
     m_glfw_ctx->~GlfwContext();
   }
+  if (m_job_system) {
+    m_job_system->~JobSystem();
+  }
 
   arena_release(engine_arena);
 }
@@ -177,6 +183,11 @@ void Application::run(const std::atomic<bool>* external_stop) {
 }
 
 void Application::frame() {
+  // Last frame's snapshots were consumed by draw_windows, their memory stays in that frame's slot
+  // until its fences signal
+  scene_manager.for_each([](Scene& scene) { scene.drop_render_snapshot(); });
+  m_renderer->frame_arenas().begin_frame(m_vulkan_ctx->get_vulkan_device().get());
+
   timer.begin();
   glfwPollEvents();
   timer.begin_work();
@@ -220,6 +231,14 @@ void Application::frame() {
   window_manager->update_windows(dt);
   view_manager->update_views(dt);
 
+  scene_manager.for_each([dt](Scene& scene) { scene.on_update(dt); });
+  // Recording still happens on this thread in draw_windows, the snapshot only decouples what it
+  // reads from the live pools
+  scene_manager.for_each([this](Scene& scene) {
+    if (scene.wants_render_snapshot())
+      scene.take_render_snapshot(frame_arena());
+  });
+
   m_imgui_ctx->end_dock_space();
   m_imgui_ctx->end_frame();
 
@@ -230,6 +249,9 @@ void Application::frame() {
   m_imgui_ctx->update_platform_windows();
   window_manager->process_pending_closes();
   view_manager->cleanup_closed_views();
+  scene_manager.end_frame();
+
+  m_job_system->reset_scratch();
 }
 
 void Application::on_app_event(EventVariant& e) {
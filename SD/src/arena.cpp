@@ -1,6 +1,8 @@
 #include "SD/arena.hpp"
 
+#include <atomic>
 #include <cinttypes>
+#include <mutex>
 
 #include <sys/mman.h>
 
@@ -15,6 +17,20 @@
 
 #define MemoryZero(s, z)           memset((s), 0, (z))
 
+#if ARENA_REGISTRY
+// Only the owning thread writes, readers just want a recent value
+#define ArenaStatLoad(field)   std::atomic_ref<U64>(field).load(std::memory_order_relaxed)
+#define ArenaStatStore(field, value) \
+  std::atomic_ref<U64>(field).store((value), std::memory_order_relaxed)
+#define ArenaStatAdd(field, value) ArenaStatStore(field, (field) + (value))
+#define ArenaStatSub(field, value) ArenaStatStore(field, (field) - (value))
+#else
+#define ArenaStatLoad(field)         (field)
+#define ArenaStatStore(field, value) ((void)(field), (void)(value))
+#define ArenaStatAdd(field, value)   ((void)(field), (void)(value))
+#define ArenaStatSub(field, value)   ((void)(field), (void)(value))
+#endif
+
 #if defined(__SANITIZE_ADDRESS__)
 extern "C" void __asan_poison_memory_region(const volatile void* addr, size_t size);
 extern "C" void __asan_unpoison_memory_region(const volatile void* addr, size_t size);
@@ -41,24 +57,49 @@ void* reserve_memory_large(U64 size) {
   return result;
 }
 
+void release_memory(void* ptr, U64 size) {
+  munmap(ptr, size);
+}
+
+// Over-reserves by `align` and unmaps both ends, mmap itself only aligns to the base page size
+void* reserve_memory_aligned(U64 size, U64 align) {
+  U8* raw = static_cast<U8*>(reserve_memory(size + align));
+  if (raw == nullptr) {
+    return nullptr;
+  }
+  U8* aligned = reinterpret_cast<U8*>(align_pow2(reinterpret_cast<U64>(raw), align));
+  if (aligned != raw) {
+    release_memory(raw, static_cast<U64>(aligned - raw));
+  }
+  release_memory(aligned + size, static_cast<U64>(raw + align - aligned));
+  return aligned;
+}
+
 bool commit_memory(void* ptr, U64 size) {
-  mprotect(ptr, size, PROT_READ | PROT_WRITE);
-  return true;
+  return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
 }
 
 bool commit_memory_large(void* ptr, U64 size) {
-  mprotect(ptr, size, PROT_READ | PROT_WRITE);
-  return true;
+  return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
 }
 
-void release_memory(void* ptr, U64 size) {
-  munmap(ptr, size);
+// Faults a committed range in with one call instead of one fault per page on first touch.
+// MAP_POPULATE does nothing for the PROT_NONE reservation, MADV_POPULATE_WRITE needs Linux 5.14
+// and older kernels only get the MADV_WILLNEED hint.
+void prefault_memory(void* ptr, U64 size) {
+#ifdef MADV_POPULATE_WRITE
+  if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+#endif
+  madvise(ptr, size, MADV_WILLNEED);
 }
 
+// 0 when the kernel has no hugetlbfs support, LARGE_PAGES arenas then use transparent huge pages
 U64 get_large_page_size() {
   FILE* fp = fopen("/proc/meminfo", "r");
   if (!fp) {
-    std::abort();
+    return 0;
   }
 
   char label[64]{};
@@ -75,11 +116,23 @@ U64 get_large_page_size() {
   fclose(fp);
 
   if (!found) {
-    std::abort();
+    return 0;
   }
   return value * 1024uz;
 }
 
+U64 get_transparent_huge_page_size() {
+  U64   size = mb(2uz);
+  FILE* fp   = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+  if (fp) {
+    if (fscanf(fp, "%" SCNu64, &size) != 1) {
+      size = mb(2uz);
+    }
+    fclose(fp);
+  }
+  return size;
+}
+
 U64 get_page_size() {
   long page_size = sysconf(_SC_PAGESIZE);
   if (page_size == -1) {
@@ -88,29 +141,56 @@ U64 get_page_size() {
   return static_cast<U64>(page_size);
 }
 
-Arena* arena_alloc(const ArenaParams params) {
+// Maps a block without registering it, chained blocks count towards their first block
+Arena* arena_alloc_block(const ArenaParams& params) {
   U64 reserve_size = params.reserve_size;
   U64 commit_size  = params.commit_size;
 
   LOCAL_PERSIST U64 large_page_size = get_large_page_size();
+  LOCAL_PERSIST U64 thp_size        = get_transparent_huge_page_size();
   LOCAL_PERSIST U64 page_size       = get_page_size();
 
-  void* base = params.optional_backing_buffer;
+  ArenaFlags flags = params.flags;
+  void*      base  = params.optional_backing_buffer;
   if (base == nullptr) {
-    if (params.flags & ArenaFlags::LARGE_PAGES) {
+    bool committed = false;
+    if ((flags & ArenaFlags::LARGE_PAGES) && large_page_size != 0) {
       reserve_size = align_pow2(reserve_size, large_page_size);
       commit_size  = align_pow2(commit_size, large_page_size);
-    } else {
-      reserve_size = align_pow2(reserve_size, page_size);
-      commit_size  = align_pow2(commit_size, page_size);
+      base         = reserve_memory_large(reserve_size);
+      committed    = base != nullptr && commit_memory_large(base, commit_size);
     }
 
-    if (params.flags & ArenaFlags::LARGE_PAGES) {
-      base = reserve_memory_large(reserve_size);
-      commit_memory_large(base, commit_size);
-    } else {
-      base = reserve_memory(reserve_size);
-      commit_memory(base, commit_size);
+    // MAP_HUGETLB fails unless pages were reserved up front, ask for transparent ones instead
+    if (!committed && (flags & ArenaFlags::LARGE_PAGES)) {
+      if (base != nullptr) {
+        release_memory(base, reserve_size);
+        base = nullptr;
+      }
+      flags &= static_cast<ArenaFlags>(~ArenaFlags::LARGE_PAGES);
+      flags |= ArenaFlags::TRANSPARENT_HUGE_PAGES;
+    }
+
+    if (base == nullptr) {
+      U64 align    = (flags & ArenaFlags::TRANSPARENT_HUGE_PAGES) ? thp_size : page_size;
+      reserve_size = align_pow2(params.reserve_size, align);
+      commit_size  = align_pow2(params.commit_size, align);
+      if (flags & ArenaFlags::TRANSPARENT_HUGE_PAGES) {
+        base = reserve_memory_aligned(reserve_size, thp_size);
+        if (base != nullptr) {
+          madvise(base, reserve_size, MADV_HUGEPAGE);
+        }
+      } else {
+        base = reserve_memory(reserve_size);
+      }
+      committed = base != nullptr && commit_memory(base, commit_size);
+    }
+
+    if (!committed) [[unlikely]] {
+      std::abort();
+    }
+    if (flags & ArenaFlags::PREFAULT) {
+      prefault_memory(base, commit_size);
     }
 
     AsanPoisonMemoryRegion(base, commit_size);
@@ -125,8 +205,8 @@ Arena* arena_alloc(const ArenaParams params) {
   AsanUnpoisonMemoryRegion(base, sizeof(Arena));
   Arena* arena         = static_cast<Arena*>(base);
   arena->current       = arena;
-  arena->flags         = params.flags;
-  arena->commit_size   = params.commit_size;
+  arena->flags         = flags;
+  arena->commit_size   = commit_size;
   arena->reserve_size  = params.reserve_size;
   arena->base_position = 0;
   arena->position      = sizeof(Arena);
@@ -134,12 +214,56 @@ Arena* arena_alloc(const ArenaParams params) {
   arena->reserved      = reserve_size;
   arena->location      = params.location;
   arena->name          = params.name;
+  arena->free_last     = nullptr;
+  arena->free_size     = 0;
+  arena->free_list_cap = params.free_list_cap;
+  arena->registry_prev = nullptr;
+  arena->registry_next = nullptr;
+  return arena;
+}
 
-  // TODO: arenatable debug
+std::mutex g_arena_registry_mutex;
+Arena*     g_arena_registry_first = nullptr;
+U64        g_arena_registry_count = 0;
+
+Arena* arena_alloc(const ArenaParams params) {
+  Arena* arena           = arena_alloc_block(params);
+  arena->stat_position   = arena->position;
+  arena->stat_high_water = arena->position;
+  arena->stat_committed  = arena->committed;
+  arena->stat_reserved   = arena->reserved;
+  arena->stat_blocks     = 1;
+
+#if ARENA_REGISTRY
+  std::lock_guard lock(g_arena_registry_mutex);
+  arena->registry_next = g_arena_registry_first;
+  if (g_arena_registry_first)
+    g_arena_registry_first->registry_prev = arena;
+  g_arena_registry_first = arena;
+  g_arena_registry_count++;
+#endif
   return arena;
 }
 
 void arena_release(Arena* arena) {
+#if ARENA_REGISTRY
+  {
+    std::lock_guard lock(g_arena_registry_mutex);
+    if (arena->registry_prev)
+      arena->registry_prev->registry_next = arena->registry_next;
+    else
+      g_arena_registry_first = arena->registry_next;
+    if (arena->registry_next)
+      arena->registry_next->registry_prev = arena->registry_prev;
+    g_arena_registry_count--;
+  }
+#endif
+
+  for (Arena *n{arena->free_last}, *prev = nullptr; n != nullptr; n = prev) {
+    prev = n->prev;
+    AsanUnpoisonMemoryRegion(n, n->committed);
+    release_memory(n, n->reserved);
+  }
   for (Arena *n{arena->current}, *prev = nullptr; n != nullptr; n = prev) {
     prev = n->prev;
     AsanUnpoisonMemoryRegion(n, n->committed);
@@ -147,6 +271,31 @@ void arena_release(Arena* arena) {
   }
 }
 
+// Returns the number of newly committed bytes
+U64 commit_block_to(Arena* current, U64 pos_post) {
+  if (current->committed >= pos_post)
+    return 0;
+  U64 commit_post_aligned = pos_post + current->commit_size - 1;
+  commit_post_aligned -= commit_post_aligned % current->commit_size;
+  U64 commit_post_clamped = clamp_top(commit_post_aligned, current->reserved);
+  U64 commit_size         = commit_post_clamped - current->committed;
+  U8* commit_ptr          = reinterpret_cast<U8*>(current) + current->committed;
+  bool ok                 = (current->flags & ArenaFlags::LARGE_PAGES)
+                                ? commit_memory_large(commit_ptr, commit_size)
+                                : commit_memory(commit_ptr, commit_size);
+  if (!ok) [[unlikely]] {
+    // Left uncommitted, push aborts and try_extend reports failure
+    return 0;
+  }
+  if (current->flags & ArenaFlags::PREFAULT) {
+    prefault_memory(commit_ptr, commit_size);
+  }
+  AsanPoisonMemoryRegion(commit_ptr, commit_size);
+  U64 committed_pre  = current->committed;
+  current->committed = commit_post_clamped;
+  return current->committed - committed_pre;
+}
+
 void* Arena::push(this Arena& arena, U64 size, U64 align, bool zero) {
   Arena* current  = arena.current;
   U64    pos_pre  = align_pow2(current->position, align);
@@ -159,7 +308,21 @@ void* Arena::push(this Arena& arena, U64 size, U64 align, bool zero) {
 
   if (current->reserved < pos_post && !(arena.flags & ArenaFlags::NO_CHAIN)) {
     Arena* new_block = nullptr;
-    // TODO: FREE_LIST OPTIONAL THINGY
+#if ARENA_FREE_LIST
+    // First popped block big enough, its pages are still committed
+    for (Arena *block = arena.free_last, *next = nullptr; block != nullptr;
+         next = block, block = block->prev) {
+      if (block->reserved < align_pow2(sizeof(Arena), align) + size)
+        continue;
+      if (next)
+        next->prev = block->prev;
+      else
+        arena.free_last = block->prev;
+      arena.free_size -= block->committed;
+      new_block = block;
+      break;
+    }
+#endif
 
     if (new_block == nullptr) {
       U64 res_size    = current->reserve_size;
@@ -168,14 +331,17 @@ void* Arena::push(this Arena& arena, U64 size, U64 align, bool zero) {
         res_size    = align_pow2(size + sizeof(Arena), align);
         commit_size = align_pow2(size + sizeof(Arena), align);
       }
-      new_block    = arena_alloc({.flags        = current->flags,
-                                  .reserve_size = res_size,
-                                  .commit_size  = commit_size,
-                                  .location     = current->location});
+      new_block    = arena_alloc_block({.flags        = current->flags,
+                                        .reserve_size = res_size,
+                                        .commit_size  = commit_size,
+                                        .location     = current->location});
       size_to_zero = 0;
+      ArenaStatAdd(arena.stat_committed, new_block->committed);
+      ArenaStatAdd(arena.stat_reserved, new_block->reserved);
     } else {
-      size_to_zero = size;
+      size_to_zero = zero ? size : 0;
     }
+    ArenaStatAdd(arena.stat_blocks, 1);
 
     new_block->base_position = current->base_position + current->reserved;
     SLLStackPush_N(arena.current, new_block, prev);
@@ -186,20 +352,7 @@ void* Arena::push(this Arena& arena, U64 size, U64 align, bool zero) {
   }
 
   // commit new page
-  if (current->committed < pos_post) {
-    U64 commit_post_aligned = pos_post + current->commit_size - 1;
-    commit_post_aligned -= commit_post_aligned % current->commit_size;
-    U64 commit_post_clamped = clamp_top(commit_post_aligned, current->reserved);
-    U64 commit_size         = commit_post_aligned - current->committed;
-    U8* commit_ptr          = reinterpret_cast<U8*>(current) + current->committed;
-    if (current->flags & ArenaFlags::LARGE_PAGES) {
-      commit_memory_large(commit_ptr, commit_size);
-    } else {
-      commit_memory(commit_ptr, commit_size);
-    }
-    AsanPoisonMemoryRegion(commit_ptr, commit_size);
-    current->committed = commit_post_clamped;
-  }
+  ArenaStatAdd(arena.stat_committed, commit_block_to(current, pos_post));
 
   void* result = nullptr;
   if (current->committed >= pos_post) {
@@ -207,6 +360,9 @@ void* Arena::push(this Arena& arena, U64 size, U64 align, bool zero) {
     current->position = pos_post;
     AsanUnpoisonMemoryRegion(result, size);
     MemoryZero(result, size_to_zero);
+    ArenaStatStore(arena.stat_position, current->base_position + pos_post);
+    if (arena.stat_position > arena.stat_high_water)
+      ArenaStatStore(arena.stat_high_water, arena.stat_position);
   }
 
   if (result == nullptr) [[unlikely]] {
@@ -215,6 +371,29 @@ void* Arena::push(this Arena& arena, U64 size, U64 align, bool zero) {
   return result;
 }
 
+bool Arena::try_extend(this Arena& arena, void* ptr, U64 old_size, U64 new_size, bool zero) {
+  Arena* current = arena.current;
+  U8*    top     = reinterpret_cast<U8*>(current) + current->position;
+  if (static_cast<U8*>(ptr) + old_size != top || new_size < old_size)
+    return false;
+
+  U64 pos_post = current->position - old_size + new_size;
+  if (pos_post > current->reserved)
+    return false;
+
+  ArenaStatAdd(arena.stat_committed, commit_block_to(current, pos_post));
+  if (current->committed < pos_post)
+    return false;
+  AsanUnpoisonMemoryRegion(top, new_size - old_size);
+  if (zero)
+    MemoryZero(top, min(current->committed, pos_post) - current->position);
+  current->position = pos_post;
+  ArenaStatStore(arena.stat_position, current->base_position + pos_post);
+  if (arena.stat_position > arena.stat_high_water)
+    ArenaStatStore(arena.stat_high_water, arena.stat_position);
+  return true;
+}
+
 U64 Arena::pos(this Arena& arena) {
   Arena* current = arena.current;
   U64    pos     = current->base_position + current->position;
@@ -225,9 +404,28 @@ void Arena::pop_to(this Arena& arena, U64 pos) {
   Arena* current = arena.current;
 
 #if ARENA_FREE_LIST
+  for (Arena* prev = 0; current->base_position >= big_pos; current = prev) {
+    prev = current->prev;
+    ArenaStatSub(arena.stat_blocks, 1);
+    if (arena.free_size + current->committed > arena.free_list_cap) {
+      ArenaStatSub(arena.stat_committed, current->committed);
+      ArenaStatSub(arena.stat_reserved, current->reserved);
+      AsanUnpoisonMemoryRegion(current, current->committed);
+      release_memory(current, current->reserved);
+      continue;
+    }
+    AsanPoisonMemoryRegion(reinterpret_cast<U8*>(current) + sizeof(Arena),
+                           current->position - sizeof(Arena));
+    current->position = sizeof(Arena);
+    arena.free_size += current->committed;
+    SLLStackPush_N(arena.free_last, current, prev);
+  }
 #else
   for (Arena* prev = 0; current->base_position >= big_pos; current = prev) {
     prev = current->prev;
+    ArenaStatSub(arena.stat_blocks, 1);
+    ArenaStatSub(arena.stat_committed, current->committed);
+    ArenaStatSub(arena.stat_reserved, current->reserved);
     AsanUnpoisonMemoryRegion(current, current->committed);
     release_memory(current, current->reserved);
   }
@@ -237,6 +435,7 @@ void Arena::pop_to(this Arena& arena, U64 pos) {
   ASSERT_ALWAYS(new_pos <= current->position);
   AsanPoisonMemoryRegion(reinterpret_cast<U8*>(current) + new_pos, (current->position - new_pos));
   current->position = new_pos;
+  ArenaStatStore(arena.stat_position, big_pos);
 }
 
 void Arena::clear(this Arena& arena) {
@@ -260,3 +459,55 @@ Temp Arena::temp_begin(this Arena& arena) {
 void Temp::end(this Temp temp) {
   temp.arena->pop_to(temp.pos);
 }
+
+struct ScratchArenas {
+  Arena* arenas[SCRATCH_ARENA_COUNT]{};
+
+  ~ScratchArenas() {
+    for (Arena* arena : arenas) {
+      if (arena)
+        arena_release(arena);
+    }
+  }
+};
+thread_local ScratchArenas g_scratch;
+
+Arena* get_scratch(Arena* const* conflicts, U64 count) {
+  for (Arena*& scratch : g_scratch.arenas) {
+    if (scratch == nullptr)
+      scratch = arena_alloc({.name = "ScratchArena"});
+
+    bool conflicting = false;
+    for (U64 i = 0; i < count; ++i) {
+      if (conflicts[i] == scratch) {
+        conflicting = true;
+        break;
+      }
+    }
+    if (!conflicting)
+      return scratch;
+  }
+  ASSERT_ALWAYS(!"Every scratch arena conflicts, raise SCRATCH_ARENA_COUNT");
+  return nullptr;
+}
+
+std::span<ArenaInfo> arena_registry_snapshot(Arena* arena) {
+#if ARENA_REGISTRY
+  std::lock_guard lock(g_arena_registry_mutex);
+  ArenaInfo*      infos = arena->push_array_no_zero<ArenaInfo>(g_arena_registry_count);
+  U64             count = 0;
+  for (Arena* a = g_arena_registry_first; a != nullptr; a = a->registry_next) {
+    infos[count++] = ArenaInfo{.name       = a->name,
+                               .location   = a->location,
+                               .position   = ArenaStatLoad(a->stat_position),
+                               .high_water = ArenaStatLoad(a->stat_high_water),
+                               .committed  = ArenaStatLoad(a->stat_committed),
+                               .reserved   = ArenaStatLoad(a->stat_reserved),
+                               .blocks     = ArenaStatLoad(a->stat_blocks)};
+  }
+  return {infos, count};
+#else
+  (void)arena;
+  return {};
+#endif
+}
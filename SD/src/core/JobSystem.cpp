@@ -0,0 +1,200 @@
+#include "SD/core/JobSystem.hpp"
+
+#include "SD/core/ecs/CommandQueue.hpp"
+#include "SD/core/logging.hpp"
+
+namespace sd {
+
+FILE_INTERNAL_BEGIN
+thread_local U32        g_worker_index = 0;
+thread_local JobSystem* g_job_system   = nullptr;
+FILE_INTERNAL_END
+
+bool WorkStealingDeque::push(Job* job) {
+  const I64 b = bottom.load(std::memory_order_relaxed);
+  const I64 t = top.load(std::memory_order_acquire);
+  if (b - t >= static_cast<I64>(CAPACITY))
+    return false;
+
+  buffer[b & MASK].store(job, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom.store(b + 1, std::memory_order_relaxed);
+  return true;
+}
+
+Job* WorkStealingDeque::pop() {
+  const I64 b = bottom.load(std::memory_order_relaxed) - 1;
+  bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  I64 t = top.load(std::memory_order_relaxed);
+
+  if (t > b) {
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  Job* job = buffer[b & MASK].load(std::memory_order_relaxed);
+  if (t == b) {
+    // Last element, race thieves for it
+    if (!top.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      job = nullptr;
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+  return job;
+}
+
+Job* WorkStealingDeque::steal() {
+  I64 t = top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const I64 b = bottom.load(std::memory_order_acquire);
+  if (t >= b)
+    return nullptr;
+
+  Job* job = buffer[t & MASK].load(std::memory_order_relaxed);
+  if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    return nullptr;
+  return job;
+}
+
+JobSystem::JobSystem(Arena* arena, U32 worker_count) {
+  if (worker_count == 0) {
+    const U32 hardware = std::thread::hardware_concurrency();
+    worker_count       = hardware > 1 ? hardware - 1 : 0;
+  }
+  m_thread_count = worker_count + 1;
+
+  m_workers = arena->push_array_no_zero<Worker>(m_thread_count);
+  for (U32 i = 0; i < m_thread_count; ++i) {
+    Worker* worker  = new (&m_workers[i]) Worker();
+    worker->scratch = arena_alloc(ArenaParams{.name = "JobScratchArena"});
+
+    worker->commands = arena_push<CommandQueue>(arena);
+    new (worker->commands) CommandQueue();
+  }
+
+  FILE_INTERNAL::g_worker_index = 0;
+  FILE_INTERNAL::g_job_system   = this;
+  for (U32 i = 1; i < m_thread_count; ++i)
+    m_workers[i].thread = std::thread([this, i] { worker_loop(i); });
+
+  log::engine::info("JobSystem started with {} worker threads", worker_count);
+}
+
+JobSystem::~JobSystem() {
+  m_running.store(false, std::memory_order_release);
+  m_queued.fetch_add(1, std::memory_order_release);
+  m_queued.notify_all();
+
+  for (U32 i = 0; i < m_thread_count; ++i) {
+    Worker& worker = m_workers[i];
+    if (worker.thread.joinable())
+      worker.thread.join();
+    worker.commands->~CommandQueue();
+    arena_release(worker.scratch);
+    worker.~Worker();
+  }
+
+  if (FILE_INTERNAL::g_job_system == this)
+    FILE_INTERNAL::g_job_system = nullptr;
+}
+
+void JobSystem::run_chunks(USize count, USize grain, JobFn fn, void* ctx) {
+  if (count == 0)
+    return;
+  if (grain == 0)
+    grain = 1;
+
+  const USize chunk_count = (count + grain - 1) / grain;
+  // Foreign threads have no deque to push to or scratch for the jobs
+  if (chunk_count == 1 || m_thread_count == 1 || !on_worker()) {
+    fn(ctx, 0, count);
+    return;
+  }
+
+  const U32 self   = worker_index();
+  Worker&   worker = m_workers[self];
+
+  // Jobs live until reset_scratch(), nested calls may still reference the ones below them
+  Job*             jobs = worker.scratch->push_array_no_zero<Job>(chunk_count);
+  std::atomic<U32> pending{static_cast<U32>(chunk_count)};
+
+  for (USize i = 0; i < chunk_count; ++i) {
+    jobs[i] = Job{
+        .fn      = fn,
+        .ctx     = ctx,
+        .begin   = i * grain,
+        .end     = min(count, (i + 1) * grain),
+        .pending = &pending,
+    };
+  }
+
+  // Keep the first chunk for this thread, the rest are up for grabs
+  for (USize i = 1; i < chunk_count; ++i) {
+    if (worker.deque.push(&jobs[i]))
+      m_queued.fetch_add(1, std::memory_order_release);
+    else
+      execute(&jobs[i]);
+  }
+  m_queued.notify_all();
+
+  execute(&jobs[0]);
+  while (pending.load(std::memory_order_acquire) != 0) {
+    if (!try_run_one(self))
+      std::this_thread::yield();
+  }
+}
+
+Arena* JobSystem::local_scratch() const {
+  return m_workers[worker_index()].scratch;
+}
+
+CommandQueue& JobSystem::local_commands() const {
+  return *m_workers[worker_index()].commands;
+}
+
+U32 JobSystem::worker_index() const {
+  ASSERT(on_worker() && "Thread is not a worker of this JobSystem");
+  return FILE_INTERNAL::g_worker_index;
+}
+
+bool JobSystem::on_worker() const {
+  return FILE_INTERNAL::g_job_system == this;
+}
+
+void JobSystem::reset_scratch() {
+  for (U32 i = 0; i < m_thread_count; ++i)
+    m_workers[i].scratch->clear();
+}
+
+void JobSystem::worker_loop(U32 index) {
+  FILE_INTERNAL::g_worker_index = index;
+  FILE_INTERNAL::g_job_system   = this;
+
+  while (m_running.load(std::memory_order_acquire)) {
+    if (try_run_one(index))
+      continue;
+    // Returns immediately when something was queued since the failed attempt
+    m_queued.wait(0, std::memory_order_acquire);
+  }
+}
+
+bool JobSystem::try_run_one(U32 index) {
+  Job* job = m_workers[index].deque.pop();
+  for (U32 i = 1; !job && i < m_thread_count; ++i)
+    job = m_workers[(index + i) % m_thread_count].deque.steal();
+
+  if (!job)
+    return false;
+
+  m_queued.fetch_sub(1, std::memory_order_relaxed);
+  execute(job);
+  return true;
+}
+
+void JobSystem::execute(Job* job) {
+  job->fn(job->ctx, job->begin, job->end);
+  job->pending->fetch_sub(1, std::memory_order_release);
+}
+
+} // namespace sd
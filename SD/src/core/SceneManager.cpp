@@ -6,6 +6,10 @@
 namespace sd {
 
 Scene* SceneManager::create(Arena* arena, const std::string& name) {
+  return create(arena, name, SceneStorage::SparseSet);
+}
+
+Scene* SceneManager::create(Arena* arena, const std::string& name, SceneStorage storage) {
   for (auto* scene : m_scenes) {
     if (scene->get_name() == name) {
       log::engine::warn("Scene '{}' already exists, returning existing scene", name);
@@ -13,7 +17,7 @@ Scene* SceneManager::create(Arena* arena, const std::string& name) {
     }
   }
   auto* scene = arena_push<Scene>(arena);
-  new (scene) Scene(name, arena);
+  new (scene) Scene(name, arena, storage);
   m_scenes.push_back(scene);
   return m_scenes.back();
 }
@@ -31,4 +35,39 @@ void SceneManager::clear() {
   m_scenes.clear();
 }
 
+void SceneManager::compact_wasteful(float waste_threshold) {
+  for (auto* scene : m_scenes) {
+    if (scene->get_storage() != SceneStorage::SparseSet)
+      continue;
+    // The pool arena may be shared with other scenes, so waste is measured from this scene's
+    // pools rather than the arena position
+    const U64 footprint = scene->em.footprint_bytes();
+    const U64 live      = scene->em.live_bytes();
+    if (footprint <= live || footprint - live < MIN_COMPACT_WASTE)
+      continue;
+    const float waste = static_cast<float>(footprint - live) / static_cast<float>(footprint);
+    if (waste < waste_threshold)
+      continue;
+
+    scene->compact();
+    log::engine::info("Compacted scene '{}': {} -> {} bytes",
+                      scene->get_name(),
+                      footprint,
+                      scene->em.footprint_bytes());
+  }
+}
+
+void SceneManager::end_frame() {
+  // Changed<T> views cover one frame, systems and render snapshots have read them by now
+  for (auto* scene : m_scenes) {
+    if (scene->get_storage() == SceneStorage::SparseSet)
+      scene->em.clear_changes();
+  }
+
+  if (auto_compact_waste <= 0.0f || ++m_frames_since_check < COMPACT_CHECK_INTERVAL)
+    return;
+  m_frames_since_check = 0;
+  compact_wasteful(auto_compact_waste);
+}
+
 } // namespace sd
@@ -2,7 +2,6 @@
 
 #include <algorithm>
 #include <limits>
-#include <vector>
 
 #include "SD/Application.hpp"
 #include "SD/core/SDImGuiContext.hpp"
@@ -250,19 +249,22 @@ void sd::View::on_render(vk::CommandBuffer cmd) {
   ASSERT(m_depth_view && "Depth view must be valid");
   ASSERT(m_extent.width > 0 && m_extent.height > 0 && "Extent must be valid");
 
-  // Collect active layers sorted by stage
-  std::vector<LayerNode*> render_layers;
+  // Collect active layers sorted by stage, insertion keeps equal stages in layer order
+  Temp        scratch       = scratch_begin();
+  LayerNode** render_layers = scratch.arena->push_array_no_zero<LayerNode*>(m_layers.size());
+  U64         layer_count   = 0;
   for (auto& layer : m_layers) {
-    if (layer.is_active)
-      render_layers.push_back(&layer);
+    if (!layer.is_active)
+      continue;
+    U64 i = layer_count++;
+    for (; i > 0 && render_layers[i - 1]->stage_id > layer.stage_id; --i)
+      render_layers[i] = render_layers[i - 1];
+    render_layers[i] = &layer;
   }
-  if (render_layers.empty())
+  if (layer_count == 0) {
+    scratch_end(scratch);
     return;
-
-  std::stable_sort(
-      render_layers.begin(),
-      render_layers.end(),
-      [](const LayerNode* a, const LayerNode* b) { return a->stage_id < b->stage_id; });
+  }
 
   // Pre-barrier: color SHADER_READ_ONLY -> COLOR_ATTACHMENT_OPTIMAL
   // Depth is already in DEPTH_STENCIL_ATTACHMENT_OPTIMAL (left from last frame)
@@ -287,8 +289,9 @@ void sd::View::on_render(vk::CommandBuffer cmd) {
                       {},
                       color_to_att);
 
-  for (auto* node : render_layers)
-    node->on_render(cmd);
+  for (U64 i = 0; i < layer_count; ++i)
+    render_layers[i]->on_render(cmd);
+  scratch_end(scratch);
 
   // Post-barrier: color -> SHADER_READ_ONLY_OPTIMAL for ImGui display
   vk::ImageMemoryBarrier color_to_read{
@@ -57,6 +57,7 @@ void WindowManager::destroy(WindowId id) {
   ASSERT(it != m_windows.end() && "Cannot destroy window,  window ID does not exist");
 
   (void)m_vulkan_ctx.get_vulkan_device()->waitIdle();
+  m_renderer.frame_arenas().forget_fences();
   it->second.render->~VulkanWindow();
   it->second.logic->~Window();
   m_windows.erase(id);
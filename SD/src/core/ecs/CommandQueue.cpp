@@ -6,29 +6,54 @@
 namespace sd {
 
 FILE_INTERNAL_BEGIN
+template<typename T>
+void execute_on_default(void* data, void* em, CommandQueue& queue) {
+  static_cast<T*>(data)->execute(*static_cast<EntityManager<ComponentGroup<>>*>(em), queue);
+}
+
 struct CommandTypeRegistrar {
   CommandTypeRegistrar() {
     CommandQueue::register_type_erased_entry(
         type_id_of<CreateEntityCmd>(),
         TypeErasedCommandEntry{
             .alloc_fn = [](Arena* a) -> void* { return a->push_array<CreateEntityCmd>(1); },
-            .execute_fn =
-                [](void* d, EntityManager<ComponentGroup<>>& em, CommandQueue& queue) {
-                  static_cast<CreateEntityCmd*>(d)->execute(em, queue);
-                },
+            .execute_fn = &execute_on_default<CreateEntityCmd>,
             .serialize_fn = [](void*       d,
                                Serializer& s) { static_cast<CreateEntityCmd*>(d)->serialize(s); },
             .deserialize_fn =
                 [](void* d, Serializer& s) { static_cast<CreateEntityCmd*>(d)->deserialize(s); },
         });
+    CommandQueue::register_type_erased_entry(
+        type_id_of<CreateEntitiesCmd>(),
+        TypeErasedCommandEntry{
+            .alloc_fn = [](Arena* a) -> void* { return a->push_array<CreateEntitiesCmd>(1); },
+            .execute_fn = &execute_on_default<CreateEntitiesCmd>,
+            .serialize_fn = [](void*       d,
+                               Serializer& s) { static_cast<CreateEntitiesCmd*>(d)->serialize(s); },
+            .deserialize_fn =
+                [](void* d, Serializer& s) { static_cast<CreateEntitiesCmd*>(d)->deserialize(s); },
+        });
+    CommandQueue::register_type_erased_entry(
+        type_id_of<AddPrefabCmd>(),
+        TypeErasedCommandEntry{
+            // The prefab blob is read into the queue arena
+            .alloc_fn =
+                [](Arena* a) -> void* {
+                  auto* cmd           = a->push_array<AddPrefabCmd>(1);
+                  cmd->m_prefab.arena = a;
+                  return cmd;
+                },
+            .execute_fn = &execute_on_default<AddPrefabCmd>,
+            .serialize_fn = [](void*       d,
+                               Serializer& s) { static_cast<AddPrefabCmd*>(d)->serialize(s); },
+            .deserialize_fn =
+                [](void* d, Serializer& s) { static_cast<AddPrefabCmd*>(d)->deserialize(s); },
+        });
     CommandQueue::register_type_erased_entry(
         type_id_of<DestroyEntityCmd>(),
         TypeErasedCommandEntry{
             .alloc_fn = [](Arena* a) -> void* { return a->push_array<DestroyEntityCmd>(1); },
-            .execute_fn =
-                [](void* d, EntityManager<ComponentGroup<>>& em, CommandQueue& queue) {
-                  static_cast<DestroyEntityCmd*>(d)->execute(em, queue);
-                },
+            .execute_fn = &execute_on_default<DestroyEntityCmd>,
             .serialize_fn = [](void*       d,
                                Serializer& s) { static_cast<DestroyEntityCmd*>(d)->serialize(s); },
             .deserialize_fn =
@@ -40,14 +65,6 @@ CommandTypeRegistrar s_registrar;
 
 FILE_INTERNAL_END
 
-void CommandQueue::apply(EntityManager<ComponentGroup<>>& em) {
-  for (U64 i = 0; i < m_commands.count; ++i) {
-    auto& cmd = m_commands.data[i];
-    cmd.execute_fn(cmd.data, em, *this);
-  }
-  clear();
-}
-
 void CommandQueue::set_entity_for_handle(EntityHandle entity_handle, Entity entity) {
   ASSERT(entity_handle.is_valid() && "Cannot set entity for invalid (sentinel) handle");
   if (entity_handle.id >= m_handle_to_entity.count) {
@@ -94,12 +111,13 @@ void CommandQueue::serialize(Serializer& serializer) const {
   serializer.write(static_cast<U32>(m_commands.count));
   for (U64 i = 0; i < m_commands.count; ++i) {
     auto& cmd = m_commands.data[i];
-    serializer.write(static_cast<U32>(cmd.type_id));
-    std::vector<std::byte> payload;
-    Serializer             payload_serializer(payload);
-    cmd.serialize_fn(cmd.data, payload_serializer);
-    serializer.write(static_cast<U32>(payload.size()));
-    serializer.write(payload.data(), payload.size());
+    serializer.write(cmd.type_id);
+    // Payload goes straight into the buffer, its size is patched in once known
+    USize size_at = serializer.get_written_size();
+    serializer.write(U32{0});
+    cmd.serialize_fn(cmd.data, serializer);
+    U32 payload_size = static_cast<U32>(serializer.get_written_size() - size_at - sizeof(U32));
+    std::memcpy(serializer.get_span().data() + size_at, &payload_size, sizeof(U32));
   }
 }
 
@@ -108,7 +126,7 @@ void CommandQueue::deserialize(Serializer& serializer) {
   clear();
 
   for (U32 i = 0; i < count; ++i) {
-    U32   type_id       = serializer.read<U32>();
+    U64   type_id       = serializer.read<U64>();
     U32   payload_size  = serializer.read<U32>();
     USize payload_start = serializer.get_offset();
 
@@ -118,11 +136,12 @@ void CommandQueue::deserialize(Serializer& serializer) {
       entry.deserialize_fn(data, serializer);
       m_commands.push(m_arena,
                       CommandNode{
-                          .type_id        = type_id,
-                          .data           = data,
-                          .execute_fn     = entry.execute_fn,
-                          .serialize_fn   = entry.serialize_fn,
-                          .deserialize_fn = entry.deserialize_fn,
+                          .type_id         = type_id,
+                          .data            = data,
+                          .manager_type_id = type_id_of<EntityManager<ComponentGroup<>>>(),
+                          .execute_fn      = entry.execute_fn,
+                          .serialize_fn    = entry.serialize_fn,
+                          .deserialize_fn  = entry.deserialize_fn,
                       });
     } else {
       log::engine::error("Unknown command type ID {} during deserialization, skipping {} bytes",
@@ -0,0 +1,36 @@
+#include "SD/core/ecs/ComponentRegistry.hpp"
+
+#include "SD/core/logging.hpp"
+
+namespace sd {
+
+U32 ComponentRegistry::register_type(const ComponentTypeInfo& info) {
+  auto [it, inserted] = m_slots.try_emplace(info.stable_id, static_cast<U32>(m_types.size()));
+  if (inserted) {
+    m_types.push_back(info);
+    return it->second;
+  }
+
+  ComponentTypeInfo& bound = m_types[it->second];
+  if (!bound.same_layout(info))
+    log::engine::warn("Component '{}' changed layout, its existing pools will be dropped",
+                      info.name);
+  bound = info;
+  m_revision++;
+  return it->second;
+}
+
+U32 ComponentRegistry::slot_of(U64 stable_id) {
+  auto it = m_slots.find(stable_id);
+  return it != m_slots.end() ? it->second : INVALID_SLOT;
+}
+
+const ComponentTypeInfo& ComponentRegistry::info(U32 slot) {
+  return m_types[slot];
+}
+
+U32 ComponentRegistry::count() {
+  return static_cast<U32>(m_types.size());
+}
+
+} // namespace sd
@@ -1,6 +1,9 @@
 #include "SD/core/layers/EngineDebugLayer.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cstdio>
+#include <cstring>
 #include <imgui.h>
 
 #include "SD/Application.hpp"
@@ -16,6 +19,15 @@
 
 namespace sd {
 
+FILE_INTERNAL_BEGIN
+// Lowercase copy of `str` pushed on `arena`
+std::string_view to_lower(Arena* arena, std::string_view str) {
+  char* out = arena->push_array_no_zero<char>(str.size());
+  std::ranges::transform(str, out, [](char c) { return static_cast<char>(tolower(c)); });
+  return {out, str.size()};
+}
+FILE_INTERNAL_END
+
 EngineDebugLayer::EngineDebugLayer(ApplicationRuntime runtime,
                                    EngineServices     services,
                                    Scene*             scene) :
@@ -39,6 +51,14 @@ void EngineDebugLayer::on_update(float dt) {
     m_timer              = 0.0f;
   }
 
+  if (m_arena_csv_enabled) {
+    m_arena_csv_timer += dt;
+    if (m_arena_csv_timer >= m_arena_csv_interval) {
+      m_arena_csv_timer = 0.0f;
+      dump_arena_csv();
+    }
+  }
+
   m_views.for_each([&](View& view) {
     if (m_log_view_resizes && view.consume_extent_changed()) {
       log::debug_layer::tagged("view",
@@ -117,6 +137,7 @@ void EngineDebugLayer::on_im_gui_menu_bar() {
     ImGui::MenuItem("Scene Inspector", nullptr, &m_show_scene_inspector);
     ImGui::MenuItem("Renderer Info", nullptr, &m_show_renderer_info);
     ImGui::MenuItem("Context Overlay", nullptr, &m_show_context_overlay);
+    ImGui::MenuItem("Arena Memory", nullptr, &m_show_arena_memory);
 
     ImGui::Separator();
     display_layout_menu();
@@ -210,11 +231,20 @@ void EngineDebugLayer::on_gui_render() {
     if (ImGui::Begin("Scene Inspector", &m_show_scene_inspector)) {
       display_scene_selector();
       ImGui::Separator();
+      display_ecs_memory();
+      ImGui::Separator();
       display_ecs_inspector();
     }
     ImGui::End();
   }
 
+  if (m_show_arena_memory) {
+    if (ImGui::Begin("Arena Memory", &m_show_arena_memory)) {
+      display_arena_memory();
+    }
+    ImGui::End();
+  }
+
   if (m_show_event_log) {
     if (ImGui::Begin("Engine Log", &m_show_event_log)) {
       display_event_log();
@@ -384,6 +414,164 @@ void EngineDebugLayer::display_scene_selector() {
   }
 }
 
+void EngineDebugLayer::display_ecs_memory() {
+  if (!m_selected_scene || !ImGui::TreeNode("Pool Memory"))
+    return;
+
+  auto& em = m_selected_scene->em;
+  ImGui::Text("Arena position: %.1f KiB", static_cast<double>(em.arena_position()) / 1024.0);
+  ImGui::Text("Entities: %d alive / %d slots", em.get_alive_entity_count(), em.get_entity_count());
+  ImGui::SameLine();
+  if (ImGui::SmallButton("Copy JSON")) {
+    std::string json = em.pool_stats_json();
+    ImGui::SetClipboardText(json.c_str());
+    log::debug_layer::tagged("memory", "{}", json);
+  }
+
+  if (ImGui::BeginTable("PoolMemory",
+                        7,
+                        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                            ImGuiTableFlags_SizingFixedFit)) {
+    ImGui::TableSetupColumn("Component", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Dense");
+    ImGui::TableSetupColumn("Capacity");
+    ImGui::TableSetupColumn("Dense KiB");
+    ImGui::TableSetupColumn("Pages");
+    ImGui::TableSetupColumn("Sparse KiB");
+    ImGui::TableSetupColumn("Abandoned KiB");
+    ImGui::TableHeadersRow();
+
+    auto kib = [](U64 bytes) { return static_cast<double>(bytes) / 1024.0; };
+    em.for_each_pool_stats([&](USize, std::string_view name, const PoolStats& stats) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%.*s", static_cast<int>(name.size()), name.data());
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu", static_cast<unsigned long long>(stats.dense_count));
+      ImGui::TableNextColumn();
+      // Mostly empty capacity is what a pool looks like after a mass despawn
+      const bool underused =
+          stats.dense_capacity > 0 && stats.dense_count * 4 < stats.dense_capacity;
+      if (underused)
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.7f, 0.2f, 1.0f));
+      ImGui::Text("%llu", static_cast<unsigned long long>(stats.dense_capacity));
+      if (underused)
+        ImGui::PopStyleColor();
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", kib(stats.dense_bytes));
+      ImGui::TableNextColumn();
+      ImGui::Text("%llu/%llu",
+                  static_cast<unsigned long long>(stats.occupied_pages),
+                  static_cast<unsigned long long>(stats.sparse_pages));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", kib(stats.sparse_bytes));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", kib(stats.abandoned_bytes));
+    });
+    ImGui::EndTable();
+  }
+  ImGui::TreePop();
+}
+
+void EngineDebugLayer::display_arena_memory() {
+  Temp                 scratch = scratch_begin();
+  std::span<ArenaInfo> arenas  = arena_registry_snapshot(scratch.arena);
+  std::ranges::sort(arenas, std::ranges::greater{}, &ArenaInfo::committed);
+
+  U64 committed = 0;
+  U64 reserved  = 0;
+  for (const ArenaInfo& info : arenas) {
+    committed += info.committed;
+    reserved += info.reserved;
+  }
+  auto kib = [](U64 bytes) { return static_cast<double>(bytes) / 1024.0; };
+  ImGui::Text("%zu arenas, %.1f KiB committed, %.1f KiB reserved",
+              arenas.size(),
+              kib(committed),
+              kib(reserved));
+
+  ImGui::Checkbox("CSV dump", &m_arena_csv_enabled);
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(80.0f);
+  ImGui::DragFloat("Interval (s)", &m_arena_csv_interval, 0.1f, 0.5f, 60.0f, "%.1f");
+  ImGui::SameLine();
+  if (ImGui::SmallButton("Dump now"))
+    dump_arena_csv();
+
+  if (ImGui::BeginTable("ArenaMemory",
+                        7,
+                        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                            ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_ScrollY)) {
+    ImGui::TableSetupColumn("Arena", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Created at", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Committed KiB");
+    ImGui::TableSetupColumn("Reserved KiB");
+    ImGui::TableSetupColumn("Position KiB");
+    ImGui::TableSetupColumn("High-water KiB");
+    ImGui::TableSetupColumn("Blocks");
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableHeadersRow();
+
+    for (const ArenaInfo& info : arenas) {
+      const char* file = info.location.file ? info.location.file : "?";
+      if (const char* slash = strrchr(file, '/'))
+        file = slash + 1;
+
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", info.name ? info.name : "(unnamed)");
+      ImGui::TableNextColumn();
+      ImGui::Text("%s:%u", file, info.location.line);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", kib(info.committed));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", kib(info.reserved));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", kib(info.position));
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", kib(info.high_water));
+      ImGui::TableNextColumn();
+      // A chain that keeps growing is what a surprise RSS spike looks like
+      const bool chained = info.blocks > 1;
+      if (chained)
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.7f, 0.2f, 1.0f));
+      ImGui::Text("%llu", static_cast<unsigned long long>(info.blocks));
+      if (chained)
+        ImGui::PopStyleColor();
+    }
+    ImGui::EndTable();
+  }
+  scratch_end(scratch);
+}
+
+void EngineDebugLayer::dump_arena_csv() {
+  FILE* f = fopen(ARENA_CSV_FILE, "a");
+  if (!f) {
+    log::debug_layer::tagged("memory", "Could not open {}", ARENA_CSV_FILE);
+    return;
+  }
+  fseek(f, 0, SEEK_END);
+  if (ftell(f) == 0)
+    fputs("time,name,file,line,committed,reserved,position,high_water,blocks\n", f);
+
+  Temp scratch = scratch_begin();
+  for (const ArenaInfo& info : arena_registry_snapshot(scratch.arena)) {
+    fprintf(f,
+            "%.3f,%s,%s,%u,%llu,%llu,%llu,%llu,%llu\n",
+            ImGui::GetTime(),
+            info.name ? info.name : "",
+            info.location.file ? info.location.file : "",
+            info.location.line,
+            static_cast<unsigned long long>(info.committed),
+            static_cast<unsigned long long>(info.reserved),
+            static_cast<unsigned long long>(info.position),
+            static_cast<unsigned long long>(info.high_water),
+            static_cast<unsigned long long>(info.blocks));
+  }
+  scratch_end(scratch);
+  fclose(f);
+}
+
 void EngineDebugLayer::display_ecs_inspector() {
   if (!m_selected_scene) {
     ImGui::Text("No Scene selected.");
@@ -391,12 +579,13 @@ void EngineDebugLayer::display_ecs_inspector() {
   }
 
   for (auto [entity, transform] : m_selected_scene->em.view<sd::components::Transform>()) {
-    std::string label = "Entity " + std::to_string(entity.index);
-    if (auto* name = m_selected_scene->em.try_get_component<sd::components::DebugName>(entity)) {
-      label = name->name + " (ID: " + std::to_string(entity.index) + ")";
-    }
+    char label[128];
+    if (auto* name = m_selected_scene->em.try_get_component<sd::components::DebugName>(entity))
+      snprintf(label, sizeof(label), "%s (ID: %u)", name->name.c_str(), entity.index);
+    else
+      snprintf(label, sizeof(label), "Entity %u", entity.index);
 
-    if (ImGui::TreeNode(label.c_str())) {
+    if (ImGui::TreeNode(label)) {
       if (auto* transform_ptr =
               m_selected_scene->em.try_get_component<sd::components::Transform>(entity)) {
         if (ImGui::TreeNode("Transform")) {
@@ -412,7 +601,7 @@ void EngineDebugLayer::display_ecs_inspector() {
           ImGui::TreePop();
         }
       }
-      if (auto* renderable =
+      if (auto renderable =
               m_selected_scene->em.try_get_component<sd::components::Renderable>(entity)) {
         if (ImGui::TreeNode("Renderable")) {
           if (ImGui::ColorEdit4("Color", renderable->color)) {
@@ -509,7 +698,7 @@ bool EngineDebugLayer::is_log_visible(const std::string& category) {
     size_t end = category.find('/', start);
     if (end == std::string::npos)
       end = category.size();
-    std::string segment = category.substr(start, end - start);
+    std::string_view segment = std::string_view(category).substr(start, end - start);
 
     CategoryNode* child = nullptr;
     for (auto& c : node->children) {
@@ -595,8 +784,9 @@ void EngineDebugLayer::display_event_log() {
 
   ImGui::Separator();
 
-  std::string search = m_log_search_buffer;
-  std::ranges::transform(search, search.begin(), tolower);
+  // Lowercased copies live until the end of the panel
+  Temp             scratch = scratch_begin();
+  std::string_view search  = FILE_INTERNAL::to_lower(scratch.arena, m_log_search_buffer);
 
   ImGuiListClipper clipper;
   clipper.Begin(static_cast<int>(total_entries));
@@ -608,12 +798,9 @@ void EngineDebugLayer::display_event_log() {
       if (!is_log_entry_visible(log) || !is_log_visible(log.category))
         continue;
 
-      if (!search.empty()) {
-        std::string msg_lower = log.message;
-        std::ranges::transform(msg_lower, msg_lower.begin(), tolower);
-        if (msg_lower.find(search) == std::string::npos)
-          continue;
-      }
+      if (!search.empty() &&
+          FILE_INTERNAL::to_lower(scratch.arena, log.message).find(search) == std::string::npos)
+        continue;
 
       // Category color
       ImVec4 cat_color = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
@@ -701,6 +888,8 @@ void EngineDebugLayer::display_event_log() {
     }
   }
 
+  scratch_end(scratch);
+
   if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
     ImGui::SetScrollHereY(1.0f);
 }
@@ -0,0 +1,43 @@
+#include "SD/core/vulkan/FrameArenaRing.hpp"
+
+#include "SD/core/vulkan/vulkan_utils.hpp"
+
+namespace sd {
+
+FrameArenaRing::FrameArenaRing() {
+  for (Slot& slot : m_slots)
+    slot.arena = arena_alloc(ArenaParams{.name = "FrameArena"});
+}
+
+FrameArenaRing::~FrameArenaRing() {
+  for (Slot& slot : m_slots)
+    arena_release(slot.arena);
+}
+
+Arena* FrameArenaRing::begin_frame(vk::Device device) {
+  m_index    = (m_index + 1) % g_max_frames_in_flight;
+  Slot& slot = m_slots[m_index];
+
+  if (slot.fences.count > 0) {
+    check_vulkan_res(device.waitForFences(static_cast<U32>(slot.fences.count),
+                                          slot.fences.data,
+                                          true,
+                                          UINT64_MAX),
+                     "Failed to wait for frame arena fences");
+  }
+  slot.fences.clear();
+  slot.arena->clear();
+  return slot.arena;
+}
+
+void FrameArenaRing::track_submit(vk::Fence fence) {
+  Slot& slot = m_slots[m_index];
+  slot.fences.push(slot.arena, fence);
+}
+
+void FrameArenaRing::forget_fences() {
+  for (Slot& slot : m_slots)
+    slot.fences.clear();
+}
+
+} // namespace sd
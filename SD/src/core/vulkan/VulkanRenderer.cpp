@@ -167,6 +167,7 @@ vk::Result VulkanRenderer::end_frame(VulkanWindow& vw) {
     log::engine::error("Failed to submit draw command buffer!");
     return err;
   }
+  m_frame_arenas.track_submit(*vw.get_frame_sync().in_flight);
 
   vk::Result res = vw.present_image(vw.current_image_index);
 
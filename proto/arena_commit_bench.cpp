@@ -0,0 +1,138 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <SD/arena.hpp>
+#include <SD/core/ecs/EntityManager.hpp>
+
+// Grows ECS pools on arenas with each commit policy and reports page faults and dTLB misses,
+// first while the pools grow and then for a pass over them. dTLB counts need perf events, they
+// read n/a when perf_event_paranoid forbids them. Run a release build.
+
+namespace bench {
+struct Velocity {
+  float x, y, z;
+};
+} // namespace bench
+
+using BenchComponents = sd::ComponentGroup<bench::Velocity>;
+
+struct Policy {
+  const char* name;
+  ArenaFlags  flags;
+};
+
+struct Counters {
+  int fd = -1;
+
+  Counters() {
+    perf_event_attr attr{};
+    attr.type           = PERF_TYPE_HW_CACHE;
+    attr.size           = sizeof(attr);
+    attr.config         = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    fd                  = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+  ~Counters() {
+    if (fd >= 0)
+      close(fd);
+  }
+
+  struct Sample {
+    long                                  faults;
+    long long                             tlb_misses;
+    std::chrono::steady_clock::time_point time;
+  };
+
+  Sample begin() const {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    return {minor_faults(), 0, std::chrono::steady_clock::now()};
+  }
+
+  void end(const char* phase, const Sample& start) const {
+    long long tlb_misses = -1;
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd, &tlb_misses, sizeof(tlb_misses)) != sizeof(tlb_misses))
+        tlb_misses = -1;
+    }
+    const double ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start.time)
+            .count();
+    char tlb[32] = "n/a";
+    if (tlb_misses >= 0)
+      std::snprintf(tlb, sizeof(tlb), "%lld", tlb_misses);
+    std::printf(" | %s %8.2f ms %8ld faults %12s dTLB misses",
+                phase,
+                ms,
+                minor_faults() - start.faults,
+                tlb);
+  }
+
+  static long minor_faults() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+  }
+};
+
+void run(const Policy& policy, U32 entity_count, const Counters& counters) {
+  sd::EntityManager<BenchComponents> em;
+  em.m_pool_arena = arena_alloc(ArenaParams{.flags        = policy.flags,
+                                            .reserve_size = gb(1uz),
+                                            .name         = "CommitBenchArena"});
+
+  std::printf("%-12s %8u entities", policy.name, entity_count);
+
+  auto grow = counters.begin();
+  for (U32 i = 0; i < entity_count; ++i) {
+    sd::Entity e = em.create();
+    em.add_component<sd::components::Transform>(e);
+    em.add_component<bench::Velocity>(e, 1.0f, 2.0f, 3.0f);
+  }
+  counters.end("grow", grow);
+
+  auto iterate = counters.begin();
+  for (auto [e, transform, velocity] : em.view<sd::components::Transform, bench::Velocity>()) {
+    transform.world_matrix(0, 3) += velocity.x;
+    transform.world_matrix(1, 3) += velocity.y;
+    transform.world_matrix(2, 3) += velocity.z;
+  }
+  counters.end("view", iterate);
+  std::printf("\n");
+
+  em.clear();
+  arena_release(em.m_pool_arena);
+}
+
+int main() {
+  const Policy policies[] = {
+      {"default", ArenaFlags::NONE},
+      {"prefault", ArenaFlags::PREFAULT},
+      {"thp", ArenaFlags::TRANSPARENT_HUGE_PAGES},
+      {"thp+prefault", ArenaFlags::TRANSPARENT_HUGE_PAGES | ArenaFlags::PREFAULT},
+      {"large", ArenaFlags::LARGE_PAGES},
+  };
+
+  Counters counters;
+  if (counters.fd < 0)
+    std::printf("perf events unavailable (%s), dTLB misses not measured\n", strerror(errno));
+
+  for (U32 entity_count : {100'000u, 1'000'000u}) {
+    for (const Policy& policy : policies)
+      run(policy, entity_count, counters);
+  }
+  return 0;
+}
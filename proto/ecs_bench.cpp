@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdio>
+
+#include <SD/arena.hpp>
+#include <SD/core/ecs/ArchetypeEntityManager.hpp>
+#include <SD/core/ecs/EntityManager.hpp>
+
+// Compares the sparse set EntityManager against ArchetypeEntityManager on creation, iteration
+// and add/remove churn. Run a release build, numbers from debug builds mean little.
+
+namespace bench {
+struct Velocity {
+  float x, y, z;
+};
+
+struct Health {
+  int current;
+  int max;
+};
+} // namespace bench
+
+using BenchComponents = sd::ComponentGroup<bench::Velocity, bench::Health>;
+
+struct Timer {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  double ms() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+  }
+};
+
+template<typename Manager>
+void run(const char* name, U32 entity_count) {
+  Manager em;
+  em.m_pool_arena = arena_alloc(ArenaParams{.name = "EcsBenchArena"});
+
+  sd::Entity* entities = em.m_pool_arena->template push_array_no_zero<sd::Entity>(entity_count);
+
+  Timer create;
+  for (U32 i = 0; i < entity_count; ++i) {
+    sd::Entity e = em.create();
+    em.template add_component<sd::components::Transform>(e);
+    em.template add_component<bench::Velocity>(e, 1.0f, 2.0f, 3.0f);
+    if (i % 2 == 0)
+      em.template add_component<bench::Health>(e, 100, 100);
+    entities[i] = e;
+  }
+  const double create_ms = create.ms();
+
+  // Integrate positions, the translation lives in the last column of the world matrix
+  float checksum = 0.0f;
+  Timer iterate;
+  for (int pass = 0; pass < 10; ++pass) {
+    for (auto [e, transform, velocity] :
+         em.template view<sd::components::Transform, bench::Velocity>()) {
+      transform.world_matrix(0, 3) += velocity.x;
+      transform.world_matrix(1, 3) += velocity.y;
+      transform.world_matrix(2, 3) += velocity.z;
+    }
+  }
+  const double iterate_ms = iterate.ms() / 10.0;
+
+  // Sparse query, only every other entity has Health
+  Timer sparse;
+  for (auto [e, velocity, health] : em.template view<bench::Velocity, bench::Health>())
+    checksum += velocity.x * static_cast<float>(health.current);
+  const double sparse_ms = sparse.ms();
+
+  // Toggling Health moves the entity between archetypes in the chunk backend
+  Timer churn;
+  for (U32 i = 0; i < entity_count; i += 4) {
+    if (!em.template try_remove_component<bench::Health>(entities[i]))
+      em.template add_component<bench::Health>(entities[i], 50, 100);
+  }
+  const double churn_ms = churn.ms();
+
+  std::printf("%-10s %8u entities | create %8.2f ms | view %7.2f ms | sparse %7.2f ms | "
+              "churn %7.2f ms | %.0f\n",
+              name,
+              entity_count,
+              create_ms,
+              iterate_ms,
+              sparse_ms,
+              churn_ms,
+              checksum);
+
+  em.clear();
+  arena_release(em.m_pool_arena);
+}
+
+int main() {
+  for (U32 entity_count : {10'000u, 100'000u, 1'000'000u}) {
+    run<sd::EntityManager<BenchComponents>>("sparse", entity_count);
+    run<sd::ArchetypeEntityManager<BenchComponents>>("archetype", entity_count);
+  }
+  return 0;
+}
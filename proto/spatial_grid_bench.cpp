@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <SD/arena.hpp>
+#include <SD/core/JobSystem.hpp>
+#include <SD/core/ecs/SpatialGrid.hpp>
+
+// Simulates frames over a SpatialGrid of 200k entities: a share of them moves, the grid is
+// updated on the JobSystem and a batch of radius, box and ray queries runs. Reports the mean and
+// worst frame against the 60 Hz budget. Run a release build.
+
+using Grid = sd::SpatialGrid<sd::ComponentGroup<>>;
+
+using sd::components::BoundingSphere;
+using sd::components::Transform;
+
+constexpr U32    ENTITY_COUNT   = 200'000;
+constexpr U32    FRAME_COUNT    = 120;
+constexpr double FRAME_BUDGET   = 1000.0 / 60.0;
+constexpr F32    WORLD_SIZE     = 2000.0f;
+constexpr U32    RADIUS_QUERIES = 256;
+constexpr U32    BOX_QUERIES    = 64;
+constexpr U32    RAYCASTS       = 64;
+
+struct Scenario {
+  const char* name;
+  // Share of entities moved every frame
+  float moving;
+  // Every n-th entity gets a sphere wider than a cell, 0 for none
+  U32 oversized_every;
+};
+
+struct FrameTimes {
+  double update = 0.0;
+  double query  = 0.0;
+  double worst  = 0.0;
+};
+
+static double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+static Transform at(F32 x, F32 y, F32 z) {
+  Transform t{VLA::Matrix4x4f::Identity()};
+  t.world_matrix(0, 3) = x;
+  t.world_matrix(1, 3) = y;
+  t.world_matrix(2, 3) = z;
+  return t;
+}
+
+void run(const Scenario& scenario, sd::JobSystem* jobs) {
+  sd::EntityManager<sd::ComponentGroup<>> em;
+  em.m_pool_arena    = arena_alloc(ArenaParams{.reserve_size = gb(1uz), .name = "GridBenchPool"});
+  Arena* grid_arena  = arena_alloc(ArenaParams{.name = "GridBenchGrid"});
+  Arena* query_arena = arena_alloc(ArenaParams{.name = "GridBenchQuery"});
+
+  std::mt19937                        rng(42);
+  std::uniform_real_distribution<F32> coord(0.0f, WORLD_SIZE);
+  std::uniform_real_distribution<F32> radius(0.0f, 2.0f);
+  std::uniform_real_distribution<F32> jitter(-1.0f, 1.0f);
+  std::vector<sd::Entity>             entities(ENTITY_COUNT);
+  em.create_many(entities);
+  em.add_components<Transform>(entities,
+                               [&](USize) { return at(coord(rng), coord(rng), coord(rng)); });
+  em.add_components<BoundingSphere>(entities, [&](USize i) {
+    const bool oversized = scenario.oversized_every && i % scenario.oversized_every == 0;
+    return BoundingSphere{.radius = oversized ? 40.0f : radius(rng)};
+  });
+
+  Grid grid(em, grid_arena, 8.0f);
+  em.clear_changes();
+
+  const U32  moving = static_cast<U32>(static_cast<float>(ENTITY_COUNT) * scenario.moving);
+  FrameTimes times;
+  USize      found = 0;
+  for (U32 frame = 0; frame < FRAME_COUNT; ++frame) {
+    const U32 first = (frame * moving) % ENTITY_COUNT;
+    for (U32 i = 0; i < moving; ++i) {
+      em.patch<Transform>(entities[(first + i) % ENTITY_COUNT], [&](Transform& t) {
+        t.world_matrix(0, 3) += jitter(rng);
+        t.world_matrix(1, 3) += jitter(rng);
+      });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    grid.update(jobs);
+    em.clear_changes();
+    const double update = ms_since(start);
+
+    const auto query_start = std::chrono::steady_clock::now();
+    for (U32 q = 0; q < RADIUS_QUERIES; ++q) {
+      const VLA::Vector3f center{{coord(rng), coord(rng), coord(rng)}};
+      found += grid.query_radius(center, 10.0f, query_arena).size();
+    }
+    for (U32 q = 0; q < BOX_QUERIES; ++q) {
+      const F32           x = coord(rng), y = coord(rng), z = coord(rng);
+      const VLA::Vector3f min{{x, y, z}};
+      const VLA::Vector3f max{{x + 20.0f, y + 20.0f, z + 20.0f}};
+      found += grid.query_aabb(min, max, query_arena).size();
+    }
+    for (U32 q = 0; q < RAYCASTS; ++q) {
+      const VLA::Vector3f origin{{coord(rng), coord(rng), coord(rng)}};
+      const VLA::Vector3f dir{{0.6f, 0.0f, 0.8f}};
+      found += grid.raycast(origin, dir, 200.0f, query_arena).size();
+    }
+    const double query = ms_since(query_start);
+    query_arena->clear();
+
+    times.update += update;
+    times.query += query;
+    times.worst = std::max(times.worst, update + query);
+  }
+
+  const double mean = (times.update + times.query) / FRAME_COUNT;
+  std::printf("%-22s update %6.2f ms  queries %6.2f ms  worst %6.2f ms  %5.1f%% of budget "
+              "(%zu cells, %zu oversized, %zu hits)\n",
+              scenario.name,
+              times.update / FRAME_COUNT,
+              times.query / FRAME_COUNT,
+              times.worst,
+              100.0 * mean / FRAME_BUDGET,
+              grid.cell_count(),
+              grid.oversized_count(),
+              found);
+
+  em.clear();
+  arena_release(query_arena);
+  arena_release(grid_arena);
+  arena_release(em.m_pool_arena);
+}
+
+int main() {
+  Arena*        job_arena = arena_alloc(ArenaParams{.name = "GridBenchJobs"});
+  sd::JobSystem jobs(job_arena);
+
+  const Scenario scenarios[] = {
+      {"static", 0.0f, 0},
+      {"10% moving", 0.1f, 0},
+      {"all moving", 1.0f, 0},
+      {"10% moving, oversized", 0.1f, 1000},
+  };
+
+  std::printf("%u entities, %u frames, %.2f ms budget\n", ENTITY_COUNT, FRAME_COUNT, FRAME_BUDGET);
+  for (const Scenario& scenario : scenarios)
+    run(scenario, &jobs);
+  return 0;
+}
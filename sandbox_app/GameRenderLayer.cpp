@@ -3,6 +3,7 @@
 #include <cstring>
 #include <imgui.h>
 #include <ranges>
+#include <tuple>
 #include <utility>
 
 #include <SD/Application.hpp>
@@ -52,6 +53,17 @@ void GameRenderLayer::on_shader_reload() {
   reload_shaders();
 }
 
+void GameRenderLayer::on_update(float dt) {
+  (void)dt;
+  // Sorted by pipeline state before the render snapshot copies the group. Nearly free once sorted
+  // since only new or changed entities move
+  auto& drawables = scene->em.group<sd::components::Transform, sd::components::Renderable>();
+  drawables.sort<sd::components::Renderable>([](const auto& a, const auto& b) {
+    return std::tie(a.render_stage, a.material_id, a.mesh_id) <
+           std::tie(b.render_stage, b.material_id, b.mesh_id);
+  });
+}
+
 void GameRenderLayer::create_vertex_buffer() {
   constexpr std::array<sd::VertexPNUV, 3> triangle{
       {
@@ -193,11 +205,10 @@ void GameRenderLayer::on_render(vk::CommandBuffer cmd) {
 
   // todo: should be on a mesh component, (or not on the component, but indexed to or something)
 
-  for (auto [entity, transform, renderable] :
-       scene->em.view<sd::components::Transform, sd::components::Renderable>()) {
+  auto draw = [&](const sd::components::Transform& transform, const auto& renderable) {
     if ((renderable.view_mask & 1u << static_cast<uint32_t>(view_id)) == 0 ||
         renderable.render_stage != stage_id)
-      continue;
+      return;
 
     Push push{
         .mvp = view->get_projection() * transform.world_matrix,
@@ -219,6 +230,16 @@ void GameRenderLayer::on_render(vk::CommandBuffer cmd) {
     cmd.bindVertexBuffers(0, 1, &vertex_buffer, &offset);
 
     cmd.draw(m_vertex_count, 1, 0, 0);
+  };
+
+  // The snapshot is what simulation handed over this frame, the live scene is only a fallback
+  if (const sd::RenderSnapshot* snapshot = scene->render_snapshot()) {
+    for (USize i = 0; i < snapshot->drawable_count(); ++i)
+      draw(snapshot->transforms[i], snapshot->renderables[i]);
+  } else {
+    auto& drawables = scene->em.group<sd::components::Transform, sd::components::Renderable>();
+    for ([[maybe_unused]] auto [entity, transform, renderable] : drawables)
+      draw(transform, renderable);
   }
 
   cmd.endRendering();
@@ -26,6 +26,7 @@ public:
                   const char*              vert_path    = nullptr,
                   const char*              frag_path    = nullptr,
                   vk::PolygonMode          polygon_mode = {});
+  void on_update(float dt);
   void on_render(vk::CommandBuffer cmd);
   void on_shader_reload();
 };
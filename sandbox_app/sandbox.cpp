@@ -318,6 +318,7 @@ void on_load(sd::Application& app, State& state) {
 
   state.shared_scene  = app.create_scene(app.engine_arena, "MainScene");
   state.another_scene = app.create_scene(app.engine_arena, "AnotherScene");
+  state.shared_scene->enable_render_snapshots();
 
   //~ pipeline creation stuff
   sd::WindowId main_win{0};
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "SD/core/ecs/ArchetypeEntityManager.hpp"
+#include "SD/core/ecs/components.hpp"
+
+namespace sd {
+
+class ArchetypeEntityManagerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    em.m_pool_arena = arena_alloc(ArenaParams{.name = "ArchetypeTestArena"});
+  }
+  void TearDown() override {
+    em.clear();
+    arena_release(em.m_pool_arena);
+  }
+
+  ArchetypeEntityManager<ComponentGroup<>> em;
+};
+
+TEST_F(ArchetypeEntityManagerTest, AddRemove_MovesRowsBetweenArchetypes) {
+  std::vector<Entity> entities;
+  for (U32 i = 0; i < 3000; ++i) {
+    Entity e = em.create();
+    em.add_component<components::Renderable>(e, components::Renderable{.mesh_id = i});
+    if (i % 3 == 0)
+      em.add_component<components::DebugName>(e, std::to_string(i));
+    entities.push_back(e);
+  }
+
+  for (U32 i = 0; i < entities.size(); i += 2)
+    em.try_remove_component<components::Renderable>(entities[i]);
+  for (U32 i = 0; i < entities.size(); i += 5)
+    em.destroy(entities[i]);
+
+  U32 visited = 0;
+  em.view<components::Renderable, components::DebugName>().each(
+      [&](Entity e, components::Renderable& renderable, components::DebugName& name) {
+        EXPECT_EQ(name.name, std::to_string(renderable.mesh_id));
+        EXPECT_EQ(entities[renderable.mesh_id], e);
+        ++visited;
+      });
+
+  U32 expected = 0;
+  for (U32 i = 0; i < entities.size(); ++i) {
+    const bool alive = i % 5 != 0;
+    EXPECT_EQ(em.is_alive(entities[i]), alive);
+    if (!alive)
+      continue;
+
+    EXPECT_EQ(em.has_component<components::Renderable>(entities[i]), i % 2 != 0);
+    if (i % 3 == 0) {
+      EXPECT_EQ(em.get_component<components::DebugName>(entities[i]).name, std::to_string(i));
+    }
+    if (i % 2 != 0 && i % 3 == 0)
+      ++expected;
+  }
+  EXPECT_EQ(visited, expected);
+
+  U32 iterated = 0;
+  for (auto [e, renderable] : em.view<components::Renderable>()) {
+    EXPECT_EQ(em.try_get_component<components::Renderable>(e), &renderable);
+    ++iterated;
+  }
+  EXPECT_EQ(iterated, 1200u);
+}
+
+} // namespace sd
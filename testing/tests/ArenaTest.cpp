@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "SD/arena.hpp"
+
+namespace {
+
+// Small blocks so a few pushes chain, like a frame arena spilling over its first block
+ArenaParams chained_params(U64 free_list_cap) {
+  return ArenaParams{.reserve_size  = kb(64uz),
+                     .commit_size   = kb(4uz),
+                     .free_list_cap = free_list_cap,
+                     .name          = "ChainedTestArena"};
+}
+
+} // namespace
+
+TEST(ArenaTest, FreeList_ReusesPoppedBlocks) {
+  Arena* arena = arena_alloc(chained_params(mb(1uz)));
+
+  U8* first = arena->push_array<U8>(kb(48uz));
+  U8* spill = arena->push_array<U8>(kb(48uz));
+  ASSERT_NE(arena->current, arena);
+  spill[0] = 0xAB;
+
+  arena->clear();
+  EXPECT_EQ(arena->current, arena);
+  EXPECT_GT(arena->free_size, 0u);
+
+  // Same frame again, the spilled block comes back zeroed instead of being mapped anew
+  EXPECT_EQ(arena->push_array<U8>(kb(48uz)), first);
+  const U64 first_end = arena->pos();
+  U8*       reused    = arena->push_array<U8>(kb(48uz));
+  EXPECT_EQ(reused, spill);
+  EXPECT_EQ(reused[0], 0);
+  EXPECT_EQ(arena->free_size, 0u);
+
+  // Too large for any free block, a new one is mapped and the free block stays listed
+  arena->pop_to(first_end);
+  arena->push_array<U8>(kb(200uz));
+  EXPECT_GT(arena->free_size, 0u);
+  arena_release(arena);
+}
+
+TEST(ArenaTest, FreeList_ReleasesBlocksPastCap) {
+  Arena* arena = arena_alloc(chained_params(0));
+  arena->push_array<U8>(kb(48uz));
+  arena->push_array<U8>(kb(48uz));
+
+  arena->clear();
+  EXPECT_EQ(arena->free_last, nullptr);
+  EXPECT_EQ(arena->free_size, 0u);
+  arena_release(arena);
+}
+
+TEST(ArenaTest, Scratch_AvoidsConflictingArenas) {
+  Temp outer = scratch_begin();
+  U8*  kept  = outer.arena->push_array<U8>(64);
+  kept[0]    = 0xAB;
+
+  // A callee handed outer.arena gets the other scratch, popping it leaves `kept` alone
+  Temp inner = scratch_begin(outer.arena);
+  EXPECT_NE(inner.arena, outer.arena);
+  inner.arena->push_array<U8>(kb(4uz));
+  scratch_end(inner);
+  EXPECT_EQ(kept[0], 0xAB);
+
+  // Without conflicts the same arena comes back, nested temps stack on it
+  Temp nested = scratch_begin();
+  EXPECT_EQ(nested.arena, outer.arena);
+  scratch_end(nested);
+  scratch_end(outer);
+  EXPECT_EQ(outer.arena->pos(), outer.pos);
+}
+
+TEST(ArenaTest, Scratch_IsPerThread) {
+  Arena* main_scratch  = scratch_begin().arena;
+  Arena* other_scratch = nullptr;
+  std::thread([&] { other_scratch = scratch_begin().arena; }).join();
+  EXPECT_NE(main_scratch, other_scratch);
+}
+
+TEST(ArenaTest, Registry_TracksLiveArenas) {
+  Arena*      snapshot_arena = arena_alloc(ArenaParams{.name = "SnapshotArena"});
+  Arena*      arena          = arena_alloc(chained_params(mb(1uz)));
+  const char* name           = arena->name;
+
+  auto find = [&] -> const ArenaInfo* {
+    for (const ArenaInfo& info : arena_registry_snapshot(snapshot_arena)) {
+      if (info.name == name)
+        return &info;
+    }
+    return nullptr;
+  };
+
+  arena->push_array<U8>(kb(48uz));
+  arena->push_array<U8>(kb(48uz));
+  const ArenaInfo* grown = find();
+  ASSERT_NE(grown, nullptr);
+  EXPECT_EQ(grown->blocks, 2u);
+  EXPECT_EQ(grown->position, arena->pos());
+  EXPECT_GE(grown->committed, kb(96uz));
+  EXPECT_GE(grown->reserved, kb(128uz));
+
+  // The popped block stays committed on the free list, the high-water mark remembers the peak
+  const U64 peak = arena->pos();
+  arena->clear();
+  const ArenaInfo* cleared = find();
+  EXPECT_EQ(cleared->blocks, 1u);
+  EXPECT_EQ(cleared->position, arena->pos());
+  EXPECT_EQ(cleared->high_water, peak);
+  EXPECT_EQ(cleared->committed, grown->committed);
+
+  arena_release(arena);
+  EXPECT_EQ(find(), nullptr);
+  arena_release(snapshot_arena);
+}
+
+TEST(ArenaTest, TransparentHugePages_AlignReservationAndCommits) {
+  Arena* arena = arena_alloc(
+      ArenaParams{.flags = ArenaFlags::TRANSPARENT_HUGE_PAGES | ArenaFlags::PREFAULT,
+                  .name  = "ThpTestArena"});
+
+  // Commits grow a whole huge page at a time from a huge page aligned base
+  EXPECT_EQ(reinterpret_cast<U64>(arena) % arena->commit_size, 0u);
+  EXPECT_EQ(arena->committed, arena->commit_size);
+
+  U8* data = arena->push_array<U8>(arena->commit_size + kb(4uz));
+  data[arena->commit_size] = 0xAB;
+  EXPECT_EQ(arena->committed, 2 * arena->commit_size);
+  arena_release(arena);
+}
+
+TEST(ArenaTest, LargePages_FallBackWithoutHugetlbfs) {
+  Arena* arena = arena_alloc(ArenaParams{.flags = ArenaFlags::LARGE_PAGES, .name = "LargeArena"});
+
+  // Without reserved hugetlbfs pages the arena still works, on transparent huge pages
+  if (!(arena->flags & ArenaFlags::LARGE_PAGES)) {
+    EXPECT_TRUE(arena->flags & ArenaFlags::TRANSPARENT_HUGE_PAGES);
+  }
+  U8* data = arena->push_array<U8>(kb(64uz));
+  data[0]  = 0xAB;
+  arena_release(arena);
+}
@@ -61,6 +61,28 @@ TEST_F(CommandQueueTest, RemoveComponentCmd_RemovesComponent) {
   EXPECT_FALSE(em.has_component<Transform>(e));
 }
 
+TEST_F(CommandQueueTest, AddPrefabCmd_SurvivesSerialization) {
+  Entity source = em.create();
+  em.add_component<Transform>(source, Transform{VLA::Matrix4x4f::Identity()});
+
+  Arena* prefab_arena = arena_alloc(ArenaParams{.name = "PrefabArena"});
+  queue.add<AddPrefabCmd>(EntityHandle(1), 4u, em.capture_prefab(source, prefab_arena));
+
+  std::vector<std::byte> buffer;
+  Serializer             serializer(buffer);
+  queue.serialize(serializer);
+  queue.clear();
+  // The deserialized command holds its own copy of the blob
+  arena_release(prefab_arena);
+
+  CommandQueue queue2;
+  serializer.reset_offset();
+  queue2.deserialize(serializer);
+  queue2.apply(em);
+  EXPECT_EQ(em.get_alive_entity_count(), 5);
+  EXPECT_EQ(em.get_component_pool<Transform>()->size(), 5u);
+}
+
 TEST_F(CommandQueueTest, Clear_RemovesAllCommands) {
   queue.add<CreateEntityCmd>(EntityHandle(1));
   queue.add<CreateEntityCmd>(EntityHandle(2));
@@ -152,6 +152,28 @@ TEST_F(FileSerializationTest, ECS_MultipleComponentsSameEntity) {
   EXPECT_STREQ(name->name.c_str(), "EntityOne");
 }
 
+TEST_F(FileSerializationTest, ECS_DeserializeKeepsObservers) {
+  EntityManager em;
+  Entity        e1 = em.create();
+  em.add_component<DebugName>(e1, "EntityOne");
+
+  std::vector<std::byte> buffer;
+  Serializer             serializer(buffer);
+  em.serialize(serializer);
+
+  EntityManager em2;
+  int           destroyed = 0;
+  em2.observe<DebugName>(ComponentEvent::Destroy,
+                         {.fn   = [](void* user, Entity) { ++*static_cast<int*>(user); },
+                          .user = &destroyed});
+  serializer.reset_offset();
+  em2.deserialize(serializer);
+
+  EXPECT_TRUE(em2.has_component<DebugName>(e1));
+  em2.destroy(e1);
+  EXPECT_EQ(destroyed, 1);
+}
+
 TEST_F(FileSerializationTest, ECS_VerifyComponentData) {
   EntityManager em;
   Entity        e1 = em.create();
@@ -489,13 +511,13 @@ TEST_F(FileSerializationTest, ECS_AllComponentTypes) {
 
   EXPECT_EQ(em2.get_entity_count(), 2u);
 
-  const Transform*  t = em2.try_get_component<Transform>(e1);
-  const DebugName*  n = em2.try_get_component<DebugName>(e1);
-  const Renderable* r = em2.try_get_component<Renderable>(e2);
+  const Transform* t = em2.try_get_component<Transform>(e1);
+  const DebugName* n = em2.try_get_component<DebugName>(e1);
+  auto             r = em2.try_get_component<Renderable>(e2);
 
   ASSERT_NE(t, nullptr);
   ASSERT_NE(n, nullptr);
-  ASSERT_NE(r, nullptr);
+  ASSERT_TRUE(r.has_value());
 
   EXPECT_FLOAT_EQ(t->world_matrix.A[0], 1.0f);
   EXPECT_EQ(n->name, "TestEntity");
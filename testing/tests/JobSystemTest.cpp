@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "SD/core/JobSystem.hpp"
+#include "SD/core/ecs/CommandQueue.hpp"
+#include "SD/core/ecs/EntityManager.hpp"
+#include "SD/core/ecs/commands.hpp"
+#include "SD/core/ecs/components.hpp"
+
+namespace sd {
+
+namespace {
+// Only known to the test's own manager type
+struct Spin {
+  float angle;
+};
+} // namespace
+
+class JobSystemTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    arena = arena_alloc(ArenaParams{.name = "JobSystemTestArena"});
+    jobs  = new (arena_push_no_zero<JobSystem>(arena)) JobSystem(arena, 4);
+  }
+  void TearDown() override {
+    jobs->~JobSystem();
+    arena_release(arena);
+  }
+
+  Arena*     arena = nullptr;
+  JobSystem* jobs  = nullptr;
+};
+
+TEST_F(JobSystemTest, ParallelFor_VisitsEveryIndexOnce) {
+  std::vector<std::atomic<U32>> hits(10000);
+  jobs->parallel_for(hits.size(), 64, [&](USize begin, USize end) {
+    for (USize i = begin; i < end; ++i)
+      hits[i].fetch_add(1, std::memory_order_relaxed);
+  });
+
+  for (auto& hit : hits)
+    EXPECT_EQ(hit.load(), 1u);
+}
+
+TEST_F(JobSystemTest, ParEach_WritesComponentsAndDefersDestroy) {
+  EntityManager<ComponentGroup<>> em;
+  em.m_pool_arena = arena_alloc(ArenaParams{.name = "JobSystemTestPoolArena"});
+
+  std::vector<Entity> entities;
+  for (U32 i = 0; i < 4096; ++i) {
+    Entity e = em.create();
+    em.add_component<components::Renderable>(e, components::Renderable{.mesh_id = i});
+    if (i % 2 == 0)
+      em.add_component<components::Transform>(e,
+                                              components::Transform{VLA::Matrix4x4f::Identity()});
+    entities.push_back(e);
+  }
+
+  std::atomic<U32> visited{0};
+  em.view<components::Transform, components::Renderable>().par_each(
+      *jobs,
+      [&](Entity e, components::Transform&, auto renderable) {
+        renderable.mesh_id += 1;
+        visited.fetch_add(1, std::memory_order_relaxed);
+        if (renderable.mesh_id % 4 == 1)
+          jobs->local_commands().add<DestroyEntityCmd>(e);
+      },
+      128);
+  EXPECT_EQ(visited.load(), 2048u);
+
+  jobs->flush_commands(em);
+  for (U32 i = 0; i < entities.size(); ++i) {
+    if (i % 2 != 0) {
+      EXPECT_EQ(em.get_component<components::Renderable>(entities[i]).mesh_id, i);
+    } else if (i % 4 == 0) {
+      EXPECT_FALSE(em.is_alive(entities[i]));
+    } else {
+      EXPECT_EQ(em.get_component<components::Renderable>(entities[i]).mesh_id, i + 1);
+    }
+  }
+
+  arena_release(em.m_pool_arena);
+}
+
+TEST_F(JobSystemTest, ParallelFor_RunsInlineOnForeignThread) {
+  std::vector<U32> hits(1000, 0);
+  std::thread      foreign([&] {
+    EXPECT_FALSE(jobs->on_worker());
+    jobs->parallel_for(hits.size(), 16, [&](USize begin, USize end) {
+      for (USize i = begin; i < end; ++i)
+        ++hits[i];
+    });
+  });
+  foreign.join();
+
+  for (U32 hit : hits)
+    EXPECT_EQ(hit, 1u);
+}
+
+TEST_F(JobSystemTest, FlushCommands_AppliesToManagerWithExtraComponents) {
+  using Manager = EntityManager<ComponentGroup<Spin>>;
+  Manager em;
+  em.m_pool_arena = arena_alloc(ArenaParams{.name = "JobSystemTestPoolArena"});
+
+  std::vector<Entity> entities(1024);
+  em.create_many(entities);
+  em.add_components<Spin>(entities, [](USize i) { return Spin{static_cast<float>(i)}; });
+
+  em.view<Spin>().par_each(
+      *jobs,
+      [&](Entity e, Spin& spin) {
+        if (static_cast<U32>(spin.angle) % 2 == 0)
+          jobs->local_commands().add<DestroyEntityCmd, Manager>(e);
+      },
+      64);
+  jobs->flush_commands(em);
+
+  EXPECT_EQ(em.get_alive_entity_count(), 512);
+  EXPECT_FALSE(em.is_alive(entities[0]));
+  EXPECT_TRUE(em.is_alive(entities[1]));
+  arena_release(em.m_pool_arena);
+}
+
+} // namespace sd
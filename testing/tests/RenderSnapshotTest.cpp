@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "SD/core/ecs/RenderSnapshot.hpp"
+#include "SD/core/ecs/components.hpp"
+
+namespace sd {
+
+using components::Camera;
+using components::Renderable;
+using components::Transform;
+
+class RenderSnapshotTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    em.m_pool_arena = arena_alloc(ArenaParams{.name = "SnapshotTestArena"});
+    frame_arena     = arena_alloc(ArenaParams{.name = "SnapshotFrameArena"});
+
+    // Every other entity is drawable, mesh_id records its index
+    std::vector<Entity> entities(3000);
+    em.create_many(entities);
+    for (USize i = 0; i < entities.size(); ++i) {
+      em.add_component<Transform>(entities[i], VLA::Matrix4x4f::Identity());
+      if (i % 2 == 0)
+        em.add_component<Renderable>(entities[i], Renderable{.mesh_id = entities[i].index});
+    }
+    em.add_component<Camera>(entities[1]);
+  }
+  void TearDown() override {
+    em.clear();
+    arena_release(em.m_pool_arena);
+    arena_release(frame_arena);
+  }
+
+  EntityManager<ComponentGroup<>> em;
+  Arena*                          frame_arena = nullptr;
+};
+
+TEST_F(RenderSnapshotTest, Extract_GathersDrawablesWithoutGroup) {
+  const RenderSnapshot* snapshot = extract_render_snapshot(em, frame_arena);
+
+  ASSERT_EQ(snapshot->drawable_count(), 1500u);
+  EXPECT_EQ(snapshot->transforms.count, 1500u);
+  EXPECT_EQ(snapshot->renderables.count, 1500u);
+  for (USize i = 0; i < snapshot->drawable_count(); ++i)
+    EXPECT_EQ(snapshot->renderables[i].mesh_id, snapshot->entities[i].index);
+  EXPECT_EQ(snapshot->cameras.count, 1u);
+}
+
+TEST_F(RenderSnapshotTest, Extract_CopiesGroupPrefixInGroupOrder) {
+  auto&                 drawables = em.group<Transform, Renderable>();
+  const RenderSnapshot* snapshot = extract_render_snapshot(em, frame_arena);
+
+  ASSERT_EQ(snapshot->drawable_count(), drawables.size());
+  USize i = 0;
+  for ([[maybe_unused]] auto [e, transform, renderable] : drawables) {
+    EXPECT_EQ(snapshot->entities[i], e);
+    EXPECT_EQ(snapshot->renderables[i].mesh_id, renderable.mesh_id);
+    ++i;
+  }
+
+  // Later writes to the scene do not reach the snapshot
+  Entity first = snapshot->entities[0];
+  em.get_component<Renderable>(first).mesh_id = 0;
+  EXPECT_EQ(snapshot->renderables[0].mesh_id, first.index);
+}
+
+} // namespace sd
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "SD/core/JobSystem.hpp"
+#include "SD/core/ecs/SpatialGrid.hpp"
+#include "SD/core/ecs/components.hpp"
+
+namespace sd {
+
+using components::BoundingSphere;
+using components::Transform;
+
+class SpatialGridTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    em.m_pool_arena = arena_alloc(ArenaParams{.name = "SpatialTestArena"});
+    grid_arena      = arena_alloc(ArenaParams{.name = "SpatialGridArena"});
+    query_arena     = arena_alloc(ArenaParams{.name = "SpatialQueryArena"});
+  }
+  void TearDown() override {
+    em.clear();
+    arena_release(em.m_pool_arena);
+    arena_release(grid_arena);
+    arena_release(query_arena);
+  }
+
+  static Transform at(float x, float y, float z) {
+    Transform t{VLA::Matrix4x4f::Identity()};
+    t.world_matrix(0, 3) = x;
+    t.world_matrix(1, 3) = y;
+    t.world_matrix(2, 3) = z;
+    return t;
+  }
+
+  static VLA::Vector3f vec(float x, float y, float z) { return VLA::Vector3f{{x, y, z}}; }
+
+  static std::vector<U32> sorted_indices(std::span<Entity> entities) {
+    std::vector<U32> indices;
+    for (Entity e : entities)
+      indices.push_back(e.index);
+    std::sort(indices.begin(), indices.end());
+    return indices;
+  }
+
+  EntityManager<ComponentGroup<>> em;
+  Arena*                          grid_arena  = nullptr;
+  Arena*                          query_arena = nullptr;
+};
+
+TEST_F(SpatialGridTest, Queries_FollowMovedAndDestroyedEntities) {
+  // A row of points one unit apart along x, entity index i + 1 sits at x = i
+  std::vector<Entity> entities(64);
+  em.create_many(entities);
+  for (U32 i = 0; i < entities.size(); ++i)
+    em.add_component<Transform>(entities[i], at(static_cast<float>(i), 0.0f, 0.0f));
+
+  SpatialGrid<ComponentGroup<>> grid(em, grid_arena, 4.0f);
+  EXPECT_EQ(grid.size(), 64u);
+  EXPECT_EQ(sorted_indices(grid.query_radius(vec(10.0f, 0.0f, 0.0f), 1.5f, query_arena)),
+            (std::vector<U32>{10, 11, 12}));
+  EXPECT_EQ(grid.query_aabb(vec(-0.5f, -1.0f, -1.0f), vec(3.5f, 1.0f, 1.0f), query_arena).size(),
+            4u);
+
+  em.patch<Transform>(entities[0], [](Transform& t) { t = at(100.0f, 100.0f, 0.0f); });
+  em.add_component<BoundingSphere>(entities[63], BoundingSphere{.radius = 5.0f});
+  grid.update();
+  em.clear_changes();
+  EXPECT_EQ(grid.query_aabb(vec(-0.5f, -1.0f, -1.0f), vec(3.5f, 1.0f, 1.0f), query_arena).size(),
+            3u);
+  EXPECT_EQ(grid.query_radius(vec(100.0f, 100.0f, 0.0f), 0.5f, query_arena).size(), 1u);
+
+  // The bounds reach past the point itself, and are hit before the points behind them
+  std::span<Entity> hits = grid.raycast(vec(63.0f, -20.0f, 0.0f), vec(0.0f, 1.0f, 0.0f), 30.0f,
+                                        query_arena);
+  ASSERT_EQ(hits.size(), 1u);
+  EXPECT_EQ(hits[0], entities[63]);
+  hits = grid.raycast(vec(80.0f, 0.0f, 0.0f), vec(-1.0f, 0.0f, 0.0f), 30.0f, query_arena);
+  ASSERT_FALSE(hits.empty());
+  EXPECT_EQ(hits[0], entities[63]);
+
+  em.destroy(entities[63]);
+  em.try_remove_component<Transform>(entities[5]);
+  EXPECT_EQ(grid.size(), 62u);
+  EXPECT_TRUE(grid.query_radius(vec(5.0f, 0.0f, 0.0f), 0.1f, query_arena).empty());
+}
+
+TEST_F(SpatialGridTest, OversizedSpheres_ListedApartAndFoundByEveryQuery) {
+  std::vector<Entity> entities(3);
+  em.create_many(entities);
+  em.add_component<Transform>(entities[0], at(0.0f, 0.0f, 0.0f));
+  em.add_component<BoundingSphere>(entities[0], BoundingSphere{.radius = 50.0f});
+  em.add_component<Transform>(entities[1], at(40.0f, 0.0f, 0.0f));
+  em.add_component<Transform>(entities[2], at(-40.0f, 0.0f, 0.0f));
+
+  SpatialGrid<ComponentGroup<>> grid(em, grid_arena, 4.0f);
+  EXPECT_EQ(grid.oversized_count(), 1u);
+  EXPECT_EQ(sorted_indices(grid.query_radius(vec(40.0f, 0.0f, 0.0f), 0.5f, query_arena)),
+            (std::vector<U32>{entities[0].index, entities[1].index}));
+  EXPECT_EQ(grid.query_aabb(vec(30.0f, 30.0f, -1.0f), vec(31.0f, 31.0f, 1.0f), query_arena).size(),
+            1u);
+  EXPECT_EQ(grid.raycast(vec(0.0f, 100.0f, 0.0f), vec(0.0f, -1.0f, 0.0f), 60.0f, query_arena)
+                .size(),
+            1u);
+
+  // Shrunk back below the cell size it moves into a cell again
+  em.patch<BoundingSphere>(entities[0], [](BoundingSphere& b) { b.radius = 1.0f; });
+  grid.update();
+  em.clear_changes();
+  EXPECT_EQ(grid.oversized_count(), 0u);
+  EXPECT_EQ(grid.query_radius(vec(40.0f, 0.0f, 0.0f), 0.5f, query_arena).size(), 1u);
+}
+
+TEST_F(SpatialGridTest, Update_OnJobSystemRecyclesEmptiedCells) {
+  Arena*     job_arena = arena_alloc(ArenaParams{.name = "SpatialJobArena"});
+  JobSystem* jobs = new (arena_push_no_zero<JobSystem>(job_arena)) JobSystem(job_arena, 3);
+
+  // Two cells apart, so every entity has a cell of its own
+  std::vector<Entity> entities(4096);
+  em.create_many(entities);
+  em.add_components<Transform>(
+      entities, [](USize i) { return at(static_cast<float>(i) * 8.0f, 0.0f, 0.0f); });
+  SpatialGrid<ComponentGroup<>> grid(em, grid_arena, 4.0f);
+  EXPECT_EQ(grid.cell_count(), 4096u);
+
+  // Every entity crosses into the next cell each round, leaving its old cell empty
+  for (int round = 1; round <= 4; ++round) {
+    for (Entity e : entities)
+      em.patch<Transform>(e, [](Transform& t) { t.world_matrix(0, 3) += 4.0f; });
+    grid.update(jobs, 256);
+    em.clear_changes();
+  }
+  EXPECT_EQ(grid.size(), 4096u);
+  EXPECT_EQ(grid.cell_count(), 4096u);
+  EXPECT_LT(grid.m_cells.count, 2u * 4096u);
+  for (USize i = 0; i < entities.size(); i += 97) {
+    const float       x     = static_cast<float>(i) * 8.0f + 16.0f;
+    std::span<Entity> found = grid.query_radius(vec(x, 0.0f, 0.0f), 1.0f, query_arena);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(found[0], entities[i]);
+  }
+
+  jobs->~JobSystem();
+  arena_release(job_arena);
+}
+
+TEST_F(SpatialGridTest, Destroyed_StopsObservingManager) {
+  Entity e = em.create();
+  em.add_component<Transform>(e, at(0.0f, 0.0f, 0.0f));
+  {
+    SpatialGrid<ComponentGroup<>> grid(em, grid_arena);
+    EXPECT_EQ(grid.size(), 1u);
+  }
+  // Would call into the destroyed grid if its observers were still registered
+  em.destroy(e);
+  EXPECT_FALSE(em.is_alive(e));
+}
+
+} // namespace sd
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "SD/core/JobSystem.hpp"
+#include "SD/core/ecs/TransformHierarchy.hpp"
+#include "SD/core/ecs/components.hpp"
+
+namespace sd {
+
+using components::Children;
+using components::LocalTransform;
+using components::Parent;
+using components::Transform;
+
+class TransformHierarchyTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    em.m_pool_arena = arena_alloc(ArenaParams{.name = "HierarchyTestArena"});
+    hierarchy_arena = arena_alloc(ArenaParams{.name = "HierarchyNodeArena"});
+  }
+  void TearDown() override {
+    em.clear();
+    arena_release(em.m_pool_arena);
+    arena_release(hierarchy_arena);
+  }
+
+  static VLA::Matrix4x4f translation_x(float x) {
+    VLA::Matrix4x4f m = VLA::Matrix4x4f::Identity();
+    m(0, 3)           = x;
+    return m;
+  }
+
+  float world_x(Entity e) { return em.get_component<Transform>(e).world_matrix(0, 3); }
+
+  EntityManager<ComponentGroup<>> em;
+  Arena*                          hierarchy_arena = nullptr;
+};
+
+TEST_F(TransformHierarchyTest, Propagate_UpdatesOnlyDirtySubtrees) {
+  TransformHierarchy<ComponentGroup<>> hierarchy(em, hierarchy_arena);
+
+  std::vector<Entity> entities(5);
+  em.create_many(entities);
+  for (U32 i = 0; i < entities.size(); ++i) {
+    em.add_component<LocalTransform>(entities[i], LocalTransform{translation_x(1.0f + i)});
+    em.add_component<Transform>(entities[i]);
+  }
+  // 0 -> {1 -> 2, 3 -> 4}
+  hierarchy.set_parent(entities[1], entities[0]);
+  hierarchy.set_parent(entities[2], entities[1]);
+  hierarchy.set_parent(entities[3], entities[0]);
+  hierarchy.set_parent(entities[4], entities[3]);
+
+  hierarchy.propagate();
+  EXPECT_EQ(hierarchy.node_count(), 5u);
+  EXPECT_EQ(hierarchy.depth(), 3u);
+  EXPECT_FLOAT_EQ(world_x(entities[2]), 6.0f);
+  EXPECT_FLOAT_EQ(world_x(entities[4]), 10.0f);
+  em.clear_changes();
+
+  em.patch<LocalTransform>(entities[3],
+                           [](LocalTransform& local) { local.matrix = translation_x(10.0f); });
+  // Outside the dirty subtree, so propagate must leave it alone
+  em.get_component<Transform>(entities[2]).world_matrix(0, 3) = -1.0f;
+  hierarchy.propagate();
+  EXPECT_FLOAT_EQ(world_x(entities[4]), 16.0f);
+  EXPECT_FLOAT_EQ(world_x(entities[2]), -1.0f);
+}
+
+TEST_F(TransformHierarchyTest, Reparent_AndDestroyedParent_KeepLinksConsistent) {
+  TransformHierarchy<ComponentGroup<>> hierarchy(em, hierarchy_arena);
+
+  std::vector<Entity> entities(4);
+  em.create_many(entities);
+  for (U32 i = 0; i < entities.size(); ++i) {
+    em.add_component<LocalTransform>(entities[i], LocalTransform{translation_x(1.0f + i)});
+    em.add_component<Transform>(entities[i]);
+  }
+  hierarchy.set_parent(entities[1], entities[0]);
+  hierarchy.set_parent(entities[2], entities[0]);
+  hierarchy.set_parent(entities[3], entities[2]);
+
+  hierarchy.set_parent(entities[3], entities[1]);
+  EXPECT_EQ(em.get_component<Children>(entities[2]).count, 0u);
+  EXPECT_EQ(em.get_component<Children>(entities[1]).count, 1u);
+
+  // Children of a destroyed entity become roots
+  em.destroy(entities[0]);
+  hierarchy.propagate();
+  EXPECT_FLOAT_EQ(world_x(entities[1]), 2.0f);
+  EXPECT_FLOAT_EQ(world_x(entities[3]), 6.0f);
+
+  em.destroy(entities[3]);
+  EXPECT_EQ(em.get_component<Children>(entities[1]).count, 0u);
+}
+
+TEST_F(TransformHierarchyTest, InstantiatedChild_StartsAsRootAndCanBeAttached) {
+  TransformHierarchy<ComponentGroup<>> hierarchy(em, hierarchy_arena);
+  Arena* prefab_arena = arena_alloc(ArenaParams{.name = "HierarchyPrefabArena"});
+
+  std::vector<Entity> entities(3);
+  em.create_many(entities);
+  for (U32 i = 0; i < entities.size(); ++i) {
+    em.add_component<LocalTransform>(entities[i], LocalTransform{translation_x(1.0f + i)});
+    em.add_component<Transform>(entities[i]);
+  }
+  // 0 -> {1, 2}
+  hierarchy.set_parent(entities[1], entities[0]);
+  hierarchy.set_parent(entities[2], entities[0]);
+
+  Prefab              prefab = em.capture_prefab(entities[1], prefab_arena);
+  std::vector<Entity> copies(2);
+  em.instantiate(prefab, copies);
+  EXPECT_FALSE(em.has_component<Parent>(copies[0]));
+  EXPECT_EQ(em.get_component<Children>(entities[0]).count, 2u);
+
+  hierarchy.propagate();
+  EXPECT_FLOAT_EQ(world_x(copies[0]), 2.0f);
+
+  // Linked like any other entity, the original siblings keep their links
+  hierarchy.set_parent(copies[1], entities[2]);
+  hierarchy.propagate();
+  EXPECT_FLOAT_EQ(world_x(copies[1]), 6.0f);
+  EXPECT_EQ(em.get_component<Children>(entities[0]).count, 2u);
+  EXPECT_TRUE(em.try_remove_component<Parent>(copies[1]));
+  EXPECT_EQ(em.get_component<Children>(entities[2]).count, 0u);
+  const Parent& link = em.get_component<Parent>(entities[1]);
+  EXPECT_TRUE(link.prev_sibling == entities[2] || link.next_sibling == entities[2]);
+
+  arena_release(prefab_arena);
+}
+
+TEST_F(TransformHierarchyTest, Propagate_WideLevelsOnJobSystem) {
+  Arena*     job_arena = arena_alloc(ArenaParams{.name = "HierarchyJobArena"});
+  JobSystem* jobs = new (arena_push_no_zero<JobSystem>(job_arena)) JobSystem(job_arena, 3);
+  TransformHierarchy<ComponentGroup<>> hierarchy(em, hierarchy_arena);
+
+  std::vector<Entity> entities(20000);
+  em.create_many(entities);
+  em.add_components<LocalTransform>(
+      entities, [](USize i) { return LocalTransform{translation_x(static_cast<float>(i % 3))}; });
+  em.add_components<Transform>(entities, [](USize) { return Transform{}; });
+  // Eight children per node
+  for (USize i = 1; i < entities.size(); ++i)
+    hierarchy.set_parent(entities[i], entities[(i - 1) / 8]);
+
+  hierarchy.propagate(jobs, 64);
+  for (USize i = 0; i < entities.size(); i += 97) {
+    float expected = 0.0f;
+    for (USize node = i;; node = (node - 1) / 8) {
+      expected += static_cast<float>(node % 3);
+      if (node == 0)
+        break;
+    }
+    EXPECT_FLOAT_EQ(world_x(entities[i]), expected);
+  }
+  jobs->~JobSystem();
+  arena_release(job_arena);
+}
+
+TEST_F(TransformHierarchyTest, Destroyed_StopsObservingManager) {
+  {
+    TransformHierarchy<ComponentGroup<>> hierarchy(em, hierarchy_arena);
+    hierarchy.propagate();
+  }
+
+  // Would call into the destroyed hierarchy if its observers were still registered
+  Entity e = em.create();
+  em.add_component<LocalTransform>(e, LocalTransform{translation_x(1.0f)});
+  em.add_component<Transform>(e);
+  em.destroy(e);
+  EXPECT_FALSE(em.is_alive(e));
+}
+
+} // namespace sd
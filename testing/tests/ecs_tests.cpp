@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <fmt/ostream.h>
 
+#include "SD/core/ecs/ComponentRegistry.hpp"
 #include "SD/core/ecs/Entity.hpp"
 #include "SD/core/ecs/EntityManager.hpp"
 #include "SD/core/ecs/component_registration.hpp"
@@ -23,6 +25,15 @@ struct Health {
   int max;
 };
 REGISTER_SD_COMPONENT(Health);
+
+struct Frozen {};
+REGISTER_SD_COMPONENT(Frozen);
+
+// Not part of the manager's ComponentGroup, stored through the ComponentRegistry
+struct ScriptState {
+  std::string source;
+  int         calls;
+};
 } // namespace
 namespace sd {} // namespace sd
 
@@ -151,6 +162,69 @@ TEST_F(SparseEntitySetTest, Remove_MiddleElement_MaintainsIntegrity) {
   }
 }
 
+TEST_F(SparseEntitySetTest, Remove_LastInPage_RecyclesPage) {
+  sd::Entity far{5000, 0};
+  set.add(far, 1.0f, 0.0f, 0.0f);
+
+  // Untouched pages share the read only empty page
+  const U32* empty = sd::k_sparse_empty_page.data();
+  EXPECT_EQ(set.sparse_pages[0], empty);
+  const U32* page = set.sparse_pages[far.index >> set.SHIFT];
+  EXPECT_NE(page, empty);
+
+  EXPECT_TRUE(set.remove(far));
+  EXPECT_EQ(set.sparse_pages[far.index >> set.SHIFT], empty);
+  EXPECT_EQ(set.free_pages.count, 1u);
+
+  sd::Entity near{3, 0};
+  set.add(near, 2.0f, 0.0f, 0.0f);
+  EXPECT_EQ(set.sparse_pages[0], page);
+  EXPECT_EQ(set.free_pages.count, 0u);
+  EXPECT_EQ(set.get(far), nullptr);
+}
+
+TEST_F(SparseEntitySetTest, Sort_ReordersDataEntitiesAndSparseTogether) {
+  for (U32 i = 1; i <= 500; ++i)
+    set.add(sd::Entity{i, 0}, static_cast<float>((i * 7919) % 500), static_cast<float>(i), 0.0f);
+  auto by_x = [](const sd::Velocity& a, const sd::Velocity& b) { return a.x < b.x; };
+
+  EXPECT_TRUE(set.sort(by_x));
+  // A few out of place entries take the insertion sort path
+  set.get(sd::Entity{10, 0})->x = -1.0f;
+  set.get(sd::Entity{20, 0})->x = 1000.0f;
+  EXPECT_TRUE(set.sort(by_x));
+  // Sorted data is left alone
+  const U64 reorders = set.reorder_count;
+  EXPECT_FALSE(set.sort(by_x));
+  EXPECT_EQ(set.reorder_count, reorders);
+
+  EXPECT_EQ(set.dense_entities[0], (sd::Entity{10, 0}));
+  EXPECT_EQ(set.dense_entities[set.size() - 1], (sd::Entity{20, 0}));
+  for (size_t i = 0; i < set.size(); ++i) {
+    if (i > 0) {
+      EXPECT_LE(set.dense_data[i - 1].x, set.dense_data[i].x);
+    }
+    EXPECT_EQ(set.dense_index(set.dense_entities[i]), i);
+    EXPECT_FLOAT_EQ(set.dense_data[i].y, static_cast<float>(set.dense_entities[i].index));
+  }
+}
+
+TEST_F(SparseEntitySetTest, Sort_RotatedRangeDoesNotSwapQuadratically) {
+  // One descent, but every entry is half the range away from its slot
+  constexpr U32 count = 2000;
+  for (U32 i = 0; i < count; ++i)
+    set.add(sd::Entity{i + 1, 0}, static_cast<float>((i + count / 2) % count), 0.0f, 0.0f);
+  auto by_x = [](const sd::Velocity& a, const sd::Velocity& b) { return a.x < b.x; };
+
+  EXPECT_TRUE(set.sort(by_x));
+  // Insertion sort alone would make count * count / 4 swaps
+  EXPECT_LE(set.reorder_count, 6u * count);
+  for (size_t i = 0; i < set.size(); ++i) {
+    EXPECT_FLOAT_EQ(set.dense_data[i].x, static_cast<float>(i));
+    EXPECT_EQ(set.dense_index(set.dense_entities[i]), i);
+  }
+}
+
 TEST_F(SparseEntitySetTest, SerializeDeserialize_RoundTrip) {
   sd::Entity e0{0, 0};
   sd::Entity e1{100, 0};
@@ -225,6 +299,31 @@ TEST_F(EntityManagerTest, Destroy_RecyclesEntityIndex) {
   EXPECT_NE(e2.generation, e1.generation);
 }
 
+TEST_F(EntityManagerTest, AliveCount_TracksCreateAndDestroy) {
+  sd::Entity e1 = manager.create();
+  sd::Entity e2 = manager.create();
+  EXPECT_EQ(manager.get_alive_entity_count(), 2);
+
+  manager.destroy(e1);
+  manager.destroy(e1);
+  EXPECT_EQ(manager.get_alive_entity_count(), 1);
+  EXPECT_EQ(manager.get_entity_count(), 2);
+
+  manager.destroy(e2);
+  manager.create();
+  EXPECT_EQ(manager.get_alive_entity_count(), 1);
+  EXPECT_EQ(manager.get_entity_count(), 2);
+}
+
+TEST_F(EntityManagerTest, Destroy_NullEntity_IsNoOp) {
+  manager.create();
+  EXPECT_FALSE(manager.is_alive(sd::Entity{}));
+
+  manager.destroy(sd::Entity{});
+  EXPECT_EQ(manager.get_alive_entity_count(), 1);
+  EXPECT_NE(manager.create().index, 0u);
+}
+
 TEST_F(EntityManagerTest, Destroy_IncrementsGeneration) {
   sd::Entity e1  = manager.create();
   uint32_t   gen = e1.generation;
@@ -315,6 +414,482 @@ TEST_F(EntityManagerTest, View_MultipleComponents) {
   EXPECT_EQ(found[0], e1);
 }
 
+TEST_F(EntityManagerTest, View_MultipleComponents_SkipsRemovedAndDestroyed) {
+  std::vector<sd::Entity> entities;
+  for (int i = 0; i < 64; ++i) {
+    sd::Entity e = manager.create();
+    manager.add_component<sd::Velocity>(e, static_cast<float>(i), 0.0f, 0.0f);
+    if (i % 2 == 0)
+      manager.add_component<sd::Health>(e, i, 100);
+    entities.push_back(e);
+  }
+
+  manager.try_remove_component<sd::Health>(entities[4]);
+  manager.destroy(entities[6]);
+
+  int count = 0;
+  for (auto [entity, health, vel] : manager.view<sd::Health, sd::Velocity>()) {
+    EXPECT_FLOAT_EQ(vel.x, static_cast<float>(health.current));
+    EXPECT_NE(entity, entities[4]);
+    EXPECT_NE(entity, entities[6]);
+    ++count;
+  }
+  EXPECT_EQ(count, 30);
+}
+
+TEST_F(EntityManagerTest, View_ExcludeAndOptionalTerms) {
+  std::vector<sd::Entity> entities(30);
+  manager.create_many(entities);
+  for (size_t i = 0; i < entities.size(); ++i) {
+    manager.add_component<sd::Velocity>(entities[i], static_cast<float>(i), 0.0f, 0.0f);
+    if (i % 3 == 0)
+      manager.add_component<sd::Health>(entities[i], static_cast<int>(i), 100);
+  }
+
+  size_t visited = 0;
+  for (auto [entity, vel] : manager.view<sd::Velocity>(sd::exclude<sd::Health>)) {
+    EXPECT_NE(static_cast<int>(vel.x) % 3, 0);
+    ++visited;
+  }
+  EXPECT_EQ(visited, 20u);
+
+  visited            = 0;
+  size_t with_health = 0;
+  for (auto [entity, vel, health] : manager.view<sd::Velocity, sd::Optional<sd::Health>>()) {
+    if (health) {
+      EXPECT_EQ(health->current, static_cast<int>(vel.x));
+      ++with_health;
+    }
+    ++visited;
+  }
+  EXPECT_EQ(visited, 30u);
+  EXPECT_EQ(with_health, 10u);
+}
+
+TEST_F(EntityManagerTest, TagComponent_LivesInMaskWithoutPool) {
+  std::vector<sd::Entity> entities(30);
+  manager.create_many(entities);
+  for (size_t i = 0; i < entities.size(); ++i) {
+    manager.add_component<sd::Velocity>(entities[i], static_cast<float>(i), 0.0f, 0.0f);
+    if (i % 3 == 0)
+      manager.add_component<sd::Frozen>(entities[i]);
+  }
+  EXPECT_FALSE(manager.has_component_pool<sd::Frozen>());
+  EXPECT_TRUE(manager.has_component<sd::Frozen>(entities[3]));
+  EXPECT_NE(manager.try_get_component<sd::Frozen>(entities[3]), nullptr);
+  EXPECT_EQ(manager.try_get_component<sd::Frozen>(entities[4]), nullptr);
+
+  size_t visited = 0;
+  for (auto [entity, vel, frozen] : manager.view<sd::Velocity, sd::Frozen>()) {
+    EXPECT_EQ(static_cast<int>(vel.x) % 3, 0);
+    ++visited;
+  }
+  EXPECT_EQ(visited, 10u);
+
+  visited = 0;
+  for (auto [entity, vel] : manager.view<sd::Velocity>(sd::exclude<sd::Frozen>))
+    ++visited;
+  EXPECT_EQ(visited, 20u);
+
+  EXPECT_TRUE(manager.try_remove_component<sd::Frozen>(entities[3]));
+  EXPECT_FALSE(manager.has_component<sd::Frozen>(entities[3]));
+  manager.destroy(entities[6]);
+  sd::Entity reused = manager.create();
+  EXPECT_FALSE(manager.has_component<sd::Frozen>(reused));
+}
+
+TEST_F(EntityManagerTest, PoolStats_KeepCapacityAfterMassDestroy) {
+  std::vector<sd::Entity> entities(5000);
+  manager.create_many(entities);
+  for (sd::Entity e : entities)
+    manager.add_component<sd::Velocity>(e, 1.0f, 2.0f, 3.0f);
+  manager.destroy_many(std::span<const sd::Entity>(entities.data(), 4000));
+
+  size_t pools = 0;
+  manager.for_each_pool_stats([&](size_t, std::string_view, const sd::PoolStats& stats) {
+    EXPECT_EQ(stats.dense_count, 1000u);
+    EXPECT_GE(stats.dense_capacity, 5000u);
+    // Entity indices 1..5000 touched five pages, 4001..5000 still live in the last two
+    EXPECT_EQ(stats.sparse_pages, 5u);
+    EXPECT_EQ(stats.occupied_pages, 2u);
+    ++pools;
+  });
+  EXPECT_EQ(pools, 1u);
+  EXPECT_GT(manager.arena_position(), 0u);
+  EXPECT_NE(manager.pool_stats_json().find(R"("dense_count":1000)"), std::string::npos);
+}
+
+TEST_F(EntityManagerTest, PoolStats_SingleEntityPoolStaysSmall) {
+  sd::Entity e = manager.create();
+  manager.add_component<sd::Velocity>(e, 1.0f, 2.0f, 3.0f);
+
+  manager.for_each_pool_stats([&](size_t, std::string_view, const sd::PoolStats& stats) {
+    EXPECT_EQ(stats.dense_count, 1u);
+    // Only the small first blocks of the dense vectors are allocated
+    EXPECT_LT(stats.dense_bytes, kb(1));
+  });
+}
+
+TEST_F(EntityManagerTest, Compact_MovesLiveDataAndTrimsDeadTail) {
+  std::vector<sd::Entity> entities(8000);
+  manager.create_many(entities);
+  for (size_t i = 0; i < entities.size(); ++i) {
+    manager.add_component<sd::Velocity>(entities[i], static_cast<float>(i), 0.0f, 0.0f);
+    manager.add_component<sd::Health>(entities[i], static_cast<int>(i), 100);
+  }
+  auto& group = manager.group<sd::Velocity, sd::Health>();
+  EXPECT_EQ(group.size(), 8000u);
+
+  // Keep every tenth entity of the first half, the second half becomes a dead tail
+  std::vector<sd::Entity> kept;
+  for (size_t i = 0; i < entities.size(); ++i) {
+    if (i % 10 == 0 && i < 4000)
+      kept.push_back(entities[i]);
+    else
+      manager.destroy(entities[i]);
+  }
+
+  Arena*    fresh  = arena_alloc(ArenaParams{.name = "CompactTestArena"});
+  const U64 before = manager.arena_position();
+  arena_release(manager.compact(fresh));
+  EXPECT_LT(manager.arena_position(), before);
+  EXPECT_EQ(manager.get_entity_count(), static_cast<int>(kept.back().index));
+
+  for (sd::Entity e : kept) {
+    ASSERT_TRUE(manager.is_alive(e));
+    EXPECT_EQ(static_cast<int>(manager.get_component<sd::Velocity>(e).x),
+              manager.get_component<sd::Health>(e).current);
+  }
+  auto& moved = manager.group<sd::Velocity, sd::Health>();
+  EXPECT_EQ(moved.size(), kept.size());
+
+  // Trimmed slots are handed out again with a newer generation
+  sd::Entity stale = entities.back();
+  std::vector<sd::Entity> refill(4000);
+  manager.create_many(refill);
+  EXPECT_FALSE(manager.is_alive(stale));
+}
+
+TEST_F(EntityManagerTest, Compact_GenerationFloorSurvivesSerialization) {
+  std::vector<sd::Entity> entities(100);
+  manager.create_many(entities);
+  for (size_t i = 1; i < entities.size(); ++i)
+    manager.destroy(entities[i]);
+  Arena* fresh = arena_alloc(ArenaParams{.name = "CompactTestArena"});
+  arena_release(manager.compact(fresh));
+
+  std::vector<std::byte> buffer;
+  sd::Serializer         serializer(buffer);
+  manager.serialize(serializer);
+  sd::EntityManager loaded;
+  serializer.reset_offset();
+  loaded.deserialize(serializer);
+
+  // The trimmed tail is handed out again, a stale handle into it must stay dead
+  std::vector<sd::Entity> refill(99);
+  loaded.create_many(refill);
+  EXPECT_TRUE(loaded.is_alive(entities[0]));
+  EXPECT_FALSE(loaded.is_alive(entities.back()));
+}
+
+TEST_F(EntityManagerTest, FootprintBytes_IgnoresOtherManagersInSharedArena) {
+  Arena*            shared = arena_alloc(ArenaParams{.name = "SharedPoolArena"});
+  sd::EntityManager other;
+  manager.m_pool_arena = shared;
+  other.m_pool_arena   = shared;
+
+  std::vector<sd::Entity> entities(1000);
+  manager.create_many(entities);
+  for (sd::Entity e : entities)
+    manager.add_component<sd::Velocity>(e, 0.0f, 0.0f, 0.0f);
+  const U64 footprint = manager.footprint_bytes();
+  EXPECT_GE(footprint, manager.live_bytes());
+
+  std::vector<sd::Entity> others(5000);
+  other.create_many(others);
+  for (sd::Entity e : others)
+    other.add_component<sd::Velocity>(e, 0.0f, 0.0f, 0.0f);
+  EXPECT_EQ(manager.footprint_bytes(), footprint);
+  EXPECT_GT(manager.arena_position(), footprint);
+  arena_release(shared);
+}
+
+TEST_F(EntityManagerTest, RuntimeComponent_SurvivesRebindAndCompaction) {
+  std::vector<sd::Entity> entities(2000);
+  manager.create_many(entities);
+  for (size_t i = 0; i < entities.size(); ++i)
+    manager.add_runtime_component<ScriptState>(
+        entities[i], ScriptState{.source = std::string(32, 'a'), .calls = static_cast<int>(i)});
+  for (size_t i = 0; i < entities.size(); i += 2)
+    manager.destroy(entities[i]);
+
+  // A reloaded module registers the same type again, the pool keeps its rows
+  sd::ComponentRegistry::register_type<ScriptState>("ScriptState");
+  ScriptState* state = manager.try_get_runtime_component<ScriptState>(entities[1]);
+  ASSERT_NE(state, nullptr);
+  EXPECT_EQ(state->calls, 1);
+  EXPECT_EQ(manager.try_get_runtime_component<ScriptState>(entities[0]), nullptr);
+
+  arena_release(manager.compact(arena_alloc(ArenaParams{.name = "RuntimeCompactArena"})));
+  for (size_t i = 1; i < entities.size(); i += 2) {
+    state = manager.try_get_runtime_component<ScriptState>(entities[i]);
+    ASSERT_NE(state, nullptr);
+    EXPECT_EQ(state->calls, static_cast<int>(i));
+    EXPECT_EQ(state->source, std::string(32, 'a'));
+  }
+  EXPECT_TRUE(manager.remove_runtime_component<ScriptState>(entities[1]));
+  EXPECT_FALSE(manager.remove_runtime_component<ScriptState>(entities[1]));
+}
+
+TEST_F(EntityManagerTest, Group_KeepsOwnedPoolsPackedInLockstep) {
+  std::vector<sd::Entity> entities;
+  for (int i = 0; i < 64; ++i) {
+    sd::Entity e = manager.create();
+    manager.add_component<sd::Velocity>(e, static_cast<float>(i), 0.0f, 0.0f);
+    if (i % 2 == 0)
+      manager.add_component<sd::Health>(e, i, 100);
+    entities.push_back(e);
+  }
+
+  auto& group = manager.group<sd::Velocity, sd::Health>();
+  auto& same_group = manager.group<sd::Velocity, sd::Health>();
+  EXPECT_EQ(&group, &same_group);
+  EXPECT_EQ(group.size(), 32u);
+
+  manager.try_remove_component<sd::Health>(entities[4]);
+  manager.destroy(entities[6]);
+  manager.add_component<sd::Health>(entities[5], 5, 100);
+  EXPECT_EQ(group.size(), 31u);
+  EXPECT_FALSE(group.contains(entities[4]));
+  EXPECT_TRUE(group.contains(entities[5]));
+
+  auto* velocities = manager.get_component_pool<sd::Velocity>();
+  auto* healths    = manager.get_component_pool<sd::Health>();
+  for (size_t i = 0; i < group.size(); ++i) {
+    EXPECT_EQ(velocities->dense_entities[i], healths->dense_entities[i]);
+    EXPECT_FLOAT_EQ(velocities->dense_data[i].x,
+                    static_cast<float>(healths->dense_data[i].current));
+  }
+
+  size_t count = 0;
+  for (auto [entity, vel, health] : group) {
+    EXPECT_FLOAT_EQ(vel.x, static_cast<float>(health.current));
+    ++count;
+  }
+  EXPECT_EQ(count, group.size());
+}
+
+TEST_F(EntityManagerTest, GroupSort_AndSortAs_KeepPoolsAligned) {
+  std::vector<sd::Entity> entities(200);
+  manager.create_many(entities);
+  for (size_t i = 0; i < entities.size(); ++i) {
+    manager.add_component<sd::Velocity>(entities[i], static_cast<float>(i), 0.0f, 0.0f);
+    if (i % 2 == 0) {
+      manager.add_component<sd::Health>(
+          entities[i], static_cast<int>(i), static_cast<int>(i * 31 % 17));
+    }
+  }
+
+  auto& group = manager.group<sd::Velocity, sd::Health>();
+  group.sort<sd::Health>([](const sd::Health& a, const sd::Health& b) { return a.max < b.max; });
+
+  auto* velocities = manager.get_component_pool<sd::Velocity>();
+  auto* healths    = manager.get_component_pool<sd::Health>();
+  for (size_t i = 0; i < group.size(); ++i) {
+    if (i > 0) {
+      EXPECT_LE(healths->dense_data[i - 1].max, healths->dense_data[i].max);
+    }
+    EXPECT_EQ(velocities->dense_entities[i], healths->dense_entities[i]);
+    EXPECT_FLOAT_EQ(velocities->dense_data[i].x,
+                    static_cast<float>(healths->dense_data[i].current));
+  }
+}
+
+TEST_F(EntityManagerTest, SoAComponent_ProxiesAndColumnsSeeSameData) {
+  using sd::components::Renderable;
+  std::vector<sd::Entity> entities;
+  for (U32 i = 0; i < 32; ++i) {
+    sd::Entity e = manager.create();
+    manager.add_component<Renderable>(e, Renderable{.mesh_id = i, .view_mask = 1u << (i % 4)});
+    entities.push_back(e);
+  }
+
+  manager.get_component<Renderable>(entities[3]).color[1] = 0.25f;
+  manager.try_remove_component<Renderable>(entities[0]);
+
+  EXPECT_FALSE(manager.try_get_component<Renderable>(entities[0]).has_value());
+  auto renderable = manager.try_get_component<Renderable>(entities[3]);
+  ASSERT_TRUE(renderable.has_value());
+  EXPECT_EQ(renderable->mesh_id, 3u);
+  EXPECT_FLOAT_EQ(renderable->color[1], 0.25f);
+
+  auto* pool  = manager.get_component_pool<Renderable>();
+  auto  masks = pool->dense_data.column<^^Renderable::view_mask>();
+  ASSERT_EQ(masks.size(), 31u);
+  for (size_t i = 0; i < masks.size(); ++i)
+    EXPECT_EQ(masks[i], 1u << (pool->dense_data[i].mesh_id % 4));
+}
+
+TEST_F(EntityManagerTest, AddComponent_PointerSurvivesPoolGrowth) {
+  sd::Entity    first    = manager.create();
+  sd::Velocity* velocity = manager.add_component<sd::Velocity>(first, 1.0f, 2.0f, 3.0f);
+
+  for (int i = 0; i < 10000; ++i) {
+    sd::Entity e = manager.create();
+    manager.add_component<sd::Velocity>(e, static_cast<float>(i), 0.0f, 0.0f);
+  }
+
+  EXPECT_EQ(manager.try_get_component<sd::Velocity>(first), velocity);
+  EXPECT_FLOAT_EQ(velocity->z, 3.0f);
+}
+
+TEST_F(EntityManagerTest, CreateMany_AddComponents_BulkPaths) {
+  sd::Entity recycled = manager.create();
+  manager.destroy(recycled);
+
+  std::vector<sd::Entity> entities(3000);
+  manager.create_many(entities);
+  EXPECT_EQ(entities[0].index, recycled.index);
+  EXPECT_EQ(manager.get_alive_entity_count(), 3000);
+
+  std::vector<sd::Velocity> velocities(entities.size());
+  for (size_t i = 0; i < velocities.size(); ++i)
+    velocities[i] = sd::Velocity{static_cast<float>(i), 0.0f, 0.0f};
+  manager.add_components<sd::Velocity>(entities, velocities);
+  manager.add_components<sd::Health>(std::span{entities}.first(1000), [](size_t i) {
+    return sd::Health{static_cast<int>(i), 100};
+  });
+
+  for (size_t i = 0; i < entities.size(); ++i) {
+    EXPECT_FLOAT_EQ(manager.get_component<sd::Velocity>(entities[i]).x, static_cast<float>(i));
+    EXPECT_EQ(manager.has_component<sd::Health>(entities[i]), i < 1000);
+  }
+
+  manager.destroy_many(std::span{entities}.first(1500));
+  EXPECT_EQ(manager.get_alive_entity_count(), 1500);
+  EXPECT_EQ(manager.get_component_pool<sd::Velocity>()->size(), 1500u);
+}
+
+TEST_F(EntityManagerTest, Prefab_InstantiatesCapturedComponentsAndRoundTrips) {
+  Arena* prefab_arena = arena_alloc(ArenaParams{.name = "PrefabArena"});
+
+  sd::Entity source = manager.create();
+  manager.add_component<sd::Velocity>(source, 1.0f, 2.0f, 3.0f);
+  manager.add_component<sd::Health>(source, 50, 100);
+  manager.add_component<sd::Frozen>(source);
+  sd::Prefab prefab = manager.capture_prefab(source, prefab_arena);
+  EXPECT_EQ(prefab.components.count, 3u);
+
+  // Serialized and read back into a fresh prefab before spawning from it
+  std::vector<std::byte> buffer;
+  sd::Serializer         serializer(buffer);
+  prefab.serialize(serializer);
+  sd::Prefab loaded;
+  loaded.arena = prefab_arena;
+  serializer.reset_offset();
+  loaded.deserialize(serializer);
+
+  manager.track_changes<sd::Velocity>();
+  std::vector<sd::Entity> spawned(1500);
+  manager.instantiate(loaded, spawned);
+  EXPECT_EQ(manager.get_alive_entity_count(), 1501);
+  EXPECT_EQ(manager.get_component_pool<sd::Velocity>()->get_changed_entities().count, 1500u);
+  for (sd::Entity e : spawned) {
+    EXPECT_FLOAT_EQ(manager.get_component<sd::Velocity>(e).z, 3.0f);
+    EXPECT_EQ(manager.get_component<sd::Health>(e).current, 50);
+    EXPECT_TRUE(manager.has_component<sd::Frozen>(e));
+  }
+
+  // Spawned entities own their copies
+  manager.patch<sd::Health>(spawned[0], [](sd::Health& h) { h.current = 1; });
+  EXPECT_EQ(manager.get_component<sd::Health>(spawned[1]).current, 50);
+  EXPECT_EQ(manager.get_component<sd::Health>(source).current, 50);
+  arena_release(prefab_arena);
+}
+
+TEST_F(EntityManagerTest, ChangedView_VisitsOnlyTouchedEntities) {
+  manager.track_changes<sd::Velocity>();
+
+  std::vector<sd::Entity> entities(100);
+  manager.create_many(entities);
+  for (sd::Entity e : entities) {
+    manager.add_component<sd::Velocity>(e, 0.0f, 0.0f, 0.0f);
+    manager.add_component<sd::Health>(e, 100, 100);
+  }
+  EXPECT_EQ(manager.get_component_pool<sd::Velocity>()->changed_entities.count, 100u);
+  manager.clear_changes();
+
+  int destroyed = 0;
+  manager.observe<sd::Velocity>(sd::ComponentEvent::Destroy,
+                                {.fn   = [](void* user, sd::Entity) { ++*static_cast<int*>(user); },
+                                 .user = &destroyed});
+
+  manager.patch<sd::Velocity>(entities[3], [](sd::Velocity& v) { v.x = 3.0f; });
+  manager.get_mut<sd::Velocity>(entities[7]).x = 7.0f;
+  manager.patch<sd::Velocity>(entities[3], [](sd::Velocity& v) { v.y = 1.0f; });
+  manager.get_mut<sd::Velocity>(entities[9]).x = 9.0f;
+  manager.destroy(entities[9]);
+  manager.try_remove_component<sd::Velocity>(entities[0]);
+  EXPECT_EQ(destroyed, 2);
+
+  std::vector<sd::Entity> found;
+  for (auto [entity, vel, health] : manager.view<sd::Changed<sd::Velocity>, sd::Health>()) {
+    EXPECT_EQ(vel.x, static_cast<float>(entity.index - entities[0].index));
+    found.push_back(entity);
+  }
+  EXPECT_EQ(found.size(), 2u);
+
+  manager.clear_changes();
+  for ([[maybe_unused]] auto [entity, vel] : manager.view<sd::Changed<sd::Velocity>>())
+    FAIL() << "Changes should be cleared";
+}
+
+TEST_F(EntityManagerTest, ChangedView_TwoTermsRequireBothChanged) {
+  manager.track_changes<sd::Velocity>();
+  manager.track_changes<sd::Health>();
+  std::vector<sd::Entity> entities(10);
+  manager.create_many(entities);
+  for (sd::Entity e : entities) {
+    manager.add_component<sd::Velocity>(e, 0.0f, 0.0f, 0.0f);
+    manager.add_component<sd::Health>(e, 100, 100);
+  }
+  manager.clear_changes();
+
+  // Velocity changes on 0..3, Health on 2..8, so the Velocity list is the shorter driver
+  for (int i = 0; i < 4; ++i)
+    manager.get_mut<sd::Velocity>(entities[i]).x = 1.0f;
+  for (int i = 2; i < 9; ++i)
+    manager.get_mut<sd::Health>(entities[i]).current = 50;
+
+  std::vector<sd::Entity> found;
+  for (auto [entity, vel, health] :
+       manager.view<sd::Changed<sd::Velocity>, sd::Changed<sd::Health>>())
+    found.push_back(entity);
+  std::ranges::sort(found, {}, &sd::Entity::index);
+  EXPECT_EQ(found, (std::vector<sd::Entity>{entities[2], entities[3]}));
+
+  // Same result with the terms swapped
+  found.clear();
+  for (auto [entity, health, vel] :
+       manager.view<sd::Changed<sd::Health>, sd::Changed<sd::Velocity>>())
+    found.push_back(entity);
+  EXPECT_EQ(found.size(), 2u);
+}
+
+TEST_F(EntityManagerTest, Unobserve_StopsNotifications) {
+  int                   constructed = 0;
+  sd::ComponentObserver counter{
+      .fn   = [](void* user, sd::Entity) { ++*static_cast<int*>(user); },
+      .user = &constructed};
+  manager.observe<sd::Velocity>(sd::ComponentEvent::Construct, counter);
+  manager.add_component<sd::Velocity>(manager.create(), 0.0f, 0.0f, 0.0f);
+  EXPECT_EQ(constructed, 1);
+
+  manager.unobserve<sd::Velocity>(sd::ComponentEvent::Construct, counter);
+  manager.add_component<sd::Velocity>(manager.create(), 0.0f, 0.0f, 0.0f);
+  EXPECT_EQ(constructed, 1);
+}
+
 TEST_F(EntityManagerTest, View_EmptyPool_ReturnsEmptyRange) {
   for ([[maybe_unused]] auto [entity, vel] : manager.view<sd::Velocity>()) {
     FAIL() << "View should be empty for non-existent component pool";